@@ -14,6 +14,8 @@
 #include <string.h>
 
 #include "aids.c"
+#include "pipeline.h"
+#include "scheduler.h"
 
 const char *validationLayers[] = {
     "VK_LAYER_KHRONOS_validation",
@@ -317,9 +319,62 @@ int main() {
         VK_KHR_SWAPCHAIN_EXTENSION_NAME,
     };
 
+    // The scheduler needs timeline semaphores (1.2) and vkQueueSubmit2 (1.3)
+    VkPhysicalDeviceProperties deviceProperties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+
+    if (deviceProperties.apiVersion < VK_API_VERSION_1_3) {
+        fprintf(
+            stderr,
+            "[ERROR]: %s only supports Vulkan %d.%d, 1.3 is required!",
+            deviceProperties.deviceName,
+            VK_API_VERSION_MAJOR(deviceProperties.apiVersion),
+            VK_API_VERSION_MINOR(deviceProperties.apiVersion)
+        );
+        exit(EXIT_FAILURE);
+    }
+
+    VkPhysicalDeviceVulkan13Features supportedVulkan13Features = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
+    };
+
+    VkPhysicalDeviceVulkan12Features supportedVulkan12Features = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+        .pNext = &supportedVulkan13Features,
+    };
+
+    VkPhysicalDeviceFeatures2 supportedFeatures = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+        .pNext = &supportedVulkan12Features,
+    };
+
+    vkGetPhysicalDeviceFeatures2(physicalDevice, &supportedFeatures);
+
+    if (! supportedVulkan12Features.timelineSemaphore) {
+        fprintf(stderr, "[ERROR]: %s doesn't support timeline semaphores!", deviceProperties.deviceName);
+        exit(EXIT_FAILURE);
+    }
+
+    if (! supportedVulkan13Features.synchronization2) {
+        fprintf(stderr, "[ERROR]: %s doesn't support synchronization2!", deviceProperties.deviceName);
+        exit(EXIT_FAILURE);
+    }
+
+    VkPhysicalDeviceVulkan13Features vulkan13Features = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
+        .synchronization2 = VK_TRUE,
+    };
+
+    VkPhysicalDeviceVulkan12Features vulkan12Features = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+        .pNext = &vulkan13Features,
+        .timelineSemaphore = VK_TRUE,
+    };
+
     VkPhysicalDeviceFeatures deviceFeatures = {VK_FALSE};
     VkDeviceCreateInfo logicalDeviceCreateInfo = {
         .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+        .pNext = &vulkan12Features,
         .pQueueCreateInfos = queueCreateInfos,
         .queueCreateInfoCount = 2,
         .pEnabledFeatures = &deviceFeatures,
@@ -344,6 +399,12 @@ int main() {
 
     VkQueue presentQueue;
     vkGetDeviceQueue(device, indices.presentFamily, 0, &presentQueue);
+
+    Scheduler scheduler = scheduler_create(device);
+
+    // Registering a queue again returns its existing index, so the render loop can look these up when it submits
+    scheduler_add_queue(&scheduler, graphicsQueue);
+    scheduler_add_queue(&scheduler, presentQueue);
     
     const VkSurfaceFormatKHR *surfaceFormat = chooseSwapSurfaceFormat(swapChainDetails.formats, swapChainDetails.formatCount);;
     const VkPresentModeKHR presentMode = chooseSwapPresentMode(swapChainDetails.presentModes, swapChainDetails.presentModeCount);
@@ -439,50 +500,6 @@ int main() {
     kyle_destroy(vertShaderCode);
     kyle_destroy(fragShaderCode);
 
-    VkPipelineShaderStageCreateInfo vertShaderPipelineCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-        .stage = VK_SHADER_STAGE_VERTEX_BIT,
-        .module = vertShaderModule,
-        .pName = "main",
-    };
-    
-    VkPipelineShaderStageCreateInfo fragShaderPipelineCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-        .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
-        .module = fragShaderModule,
-        .pName = "main",
-    };
-    
-    const VkPipelineShaderStageCreateInfo shaderStages[] = {
-        vertShaderPipelineCreateInfo,
-        fragShaderPipelineCreateInfo,
-    };
-
-    const VkDynamicState dynamicStates[] = {
-        VK_DYNAMIC_STATE_VIEWPORT,
-        VK_DYNAMIC_STATE_SCISSOR,
-    };
-
-    VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
-        .dynamicStateCount = sizeof(dynamicStates) / sizeof(dynamicStates[0]),
-        .pDynamicStates = dynamicStates,
-    };
-
-    VkPipelineVertexInputStateCreateInfo vertexInputInfo = {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
-        .vertexBindingDescriptionCount = 0,
-        .pVertexBindingDescriptions = NULL,
-        .vertexAttributeDescriptionCount = 0,
-        .pVertexAttributeDescriptions = NULL,
-    };
-
-    VkPipelineInputAssemblyStateCreateInfo pipelineInputAssemblyCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
-        .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
-        .primitiveRestartEnable = VK_FALSE,
-    };
-
     VkViewport viewport = {
         .x = 0.0f,
         .y = 0.0f,
@@ -497,64 +514,6 @@ int main() {
         .extent = swapchainExtent,
     };
 
-    VkPipelineViewportStateCreateInfo viewPortStateCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
-        .viewportCount = 1,
-        .scissorCount = 1,
-    };
-
-    VkPipelineRasterizationStateCreateInfo rasterizer = {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
-        .depthClampEnable = VK_FALSE,
-        .rasterizerDiscardEnable = VK_FALSE,
-        .polygonMode = VK_POLYGON_MODE_FILL,
-        .lineWidth = 1.0f,
-        .cullMode = VK_CULL_MODE_BACK_BIT,
-        .frontFace = VK_FRONT_FACE_CLOCKWISE,
-        .depthBiasEnable = VK_FALSE,
-        .depthBiasConstantFactor = 0.0f,
-        .depthBiasClamp = 0.0f,
-        .depthBiasSlopeFactor = 0.0f,
-    };
-
-    VkPipelineMultisampleStateCreateInfo multisampling = {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
-        .sampleShadingEnable = VK_FALSE,
-        .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT,
-        .minSampleShading = 1.0f,
-        .pSampleMask = NULL,
-        .alphaToCoverageEnable = VK_FALSE,
-        .alphaToOneEnable = VK_FALSE,
-    };
-
-    VkPipelineColorBlendAttachmentState colorBlendAttachment = {
-        .colorWriteMask = VK_COLOR_COMPONENT_R_BIT |
-                          VK_COLOR_COMPONENT_G_BIT |
-                          VK_COLOR_COMPONENT_B_BIT |
-                          VK_COLOR_COMPONENT_A_BIT,
-        .blendEnable = VK_FALSE,
-        .srcColorBlendFactor = VK_BLEND_FACTOR_ONE,
-        .dstColorBlendFactor = VK_BLEND_FACTOR_ZERO,
-        .colorBlendOp = VK_BLEND_OP_ADD,
-        .srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
-        .dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO,
-        .alphaBlendOp = VK_BLEND_OP_ADD,
-    };
-
-    VkPipelineColorBlendStateCreateInfo colorBlending = {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
-        .logicOpEnable = VK_FALSE,
-        .logicOp = VK_LOGIC_OP_COPY,
-        .attachmentCount = 1,
-        .pAttachments = &colorBlendAttachment,
-        .blendConstants = {
-            0.0f,
-            0.0f,
-            0.0f,
-            0.0f,
-        },
-    };
-
     VkPipelineLayout pipelineLayout;
     VkPipelineLayoutCreateInfo pipelineLayoutInfo = {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
@@ -605,30 +564,11 @@ int main() {
         exit(EXIT_FAILURE);
     }
 
-    VkGraphicsPipelineCreateInfo pipelineInfo = {
-        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
-        .stageCount = 2,
-        .pStages = shaderStages,
-        .pVertexInputState = &vertexInputInfo,
-        .pInputAssemblyState = &pipelineInputAssemblyCreateInfo,
-        .pViewportState = &viewPortStateCreateInfo,
-        .pRasterizationState = &rasterizer,
-        .pMultisampleState = &multisampling,
-        .pDepthStencilState = NULL,
-        .pColorBlendState = &colorBlending,
-        .pDynamicState = &dynamicStateCreateInfo,
-        .layout = pipelineLayout,
-        .renderPass = renderPass,
-        .subpass = 0,
-        .basePipelineHandle = VK_NULL_HANDLE,
-        .basePipelineIndex = -1,
-    };
+    PipelineCache pipelineCache = pipeline_cache_create(device, 16);
+    PipelineState pipelineState = pipeline_state_default(vertShaderModule, fragShaderModule, pipelineLayout, renderPass);
 
-    VkPipeline graphicsPipeline;
-    if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, NULL, &graphicsPipeline) != VK_SUCCESS) {
-        fprintf(stderr, "[ERROR]: Failed to create graphics pipeline!");
-        exit(EXIT_FAILURE);
-    }
+    // Created up front so the first frame only does a lookup
+    pipeline_cache_get(&pipelineCache, &pipelineState);
 
     VkFramebuffer swapChainFrameBuffers[imageCount];
 
@@ -685,12 +625,16 @@ int main() {
         glfwPollEvents();
     }
 
+    scheduler_wait_idle(&scheduler);
+
     vkDestroyCommandPool(device, commandPool, NULL);
+    pipeline_cache_destroy(pipelineCache);
     vkDestroyPipelineLayout(device, pipelineLayout, NULL);
     vkDestroyRenderPass(device, renderPass, NULL);
     vkDestroyShaderModule(device, vertShaderModule, NULL);
     vkDestroyShaderModule(device, fragShaderModule, NULL);
     vkDestroySwapchainKHR(device, swapchain, NULL);
+    scheduler_destroy(scheduler);
     vkDestroySurfaceKHR(instance, surface, NULL);
     vkDestroyDevice(device, NULL);
     vkDestroyInstance(instance, NULL);
@@ -0,0 +1,1043 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "mesh.h"
+
+#define MESH_MAX_THREADS 64
+#define MESH_NO_INDEX UINT32_MAX
+#define MESH_VERTEX_CACHE_SIZE 16
+
+#define MESH_CACHE_MAGIC 0x534d4b56 // "VKMS"
+#define MESH_CACHE_VERSION 2
+#define MESH_CACHE_QUANTIZED 0x1
+#define MESH_CACHE_OPTIMIZED 0x2
+#define MESH_CACHE_ALIGNMENT 16
+
+typedef struct MeshCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t flags;
+    uint32_t vertexStride;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t indexSize;
+    uint32_t sourceModifiedNanoseconds;
+    uint64_t sourceSize;
+    int64_t sourceModified;
+    float boundsMin[3];
+    float boundsMax[3];
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+} MeshCacheHeader;
+
+typedef struct ObjCorner {
+    uint32_t position;
+    uint32_t texcoord;
+    uint32_t normal;
+} ObjCorner;
+
+typedef struct ObjData {
+    float (*positions)[3];
+    float (*texcoords)[2];
+    float (*normals)[3];
+    ObjCorner *corners;
+    uint32_t positionCount;
+    uint32_t texcoordCount;
+    uint32_t normalCount;
+    uint32_t cornerCount;
+} ObjData;
+
+// Every thread owns a newline aligned slice of the file. The first pass only counts
+// elements so that the second pass can write straight into the shared arrays.
+typedef struct ObjChunk {
+    const char *begin;
+    const char *end;
+    ObjData *data;
+    uint32_t positionCount;
+    uint32_t texcoordCount;
+    uint32_t normalCount;
+    uint32_t cornerCount;
+    uint32_t positionBase;
+    uint32_t texcoordBase;
+    uint32_t normalBase;
+    uint32_t cornerBase;
+    bool failed;
+} ObjChunk;
+
+static uint32_t mesh_thread_count(uint32_t requested) {
+    if (requested == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        requested = online > 0 ? (uint32_t) online : 1;
+    }
+
+    return requested > MESH_MAX_THREADS ? MESH_MAX_THREADS : requested;
+}
+
+static void *mesh_map_file(const char *path, size_t *length) {
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat info;
+
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return NULL;
+    }
+
+    void *data = mmap(NULL, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        return NULL;
+    }
+
+    *length = (size_t) info.st_size;
+
+    return data;
+}
+
+static void mesh_run_threads(void *(*routine)(void *), ObjChunk *chunks, uint32_t chunkCount) {
+    pthread_t threads[MESH_MAX_THREADS];
+
+    // The calling thread takes the first chunk itself
+    for (uint32_t i = 1; i < chunkCount; i += 1) {
+        if (pthread_create(&threads[i], NULL, routine, &chunks[i]) != 0) {
+            fprintf(stderr, "[ERROR]: Failed to spawn mesh loader thread!");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    routine(&chunks[0]);
+
+    for (uint32_t i = 1; i < chunkCount; i += 1) {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+// Parsing
+
+static bool obj_is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static const char *obj_skip_spaces(const char *p, const char *end) {
+    while (p < end && obj_is_space(*p)) {
+        p += 1;
+    }
+
+    return p;
+}
+
+static const char *obj_line_end(const char *p, const char *end) {
+    const char *newline = memchr(p, '\n', (size_t) (end - p));
+    return newline ? newline : end;
+}
+
+static const char *obj_parse_float(const char *p, const char *end, float *out) {
+    static const double powers[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+        1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+    };
+
+    p = obj_skip_spaces(p, end);
+
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p += 1;
+    }
+
+    double value = 0.0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        value = value * 10.0 + (*p - '0');
+        p += 1;
+    }
+
+    if (p < end && *p == '.') {
+        p += 1;
+
+        double fraction = 0.0;
+        int digits = 0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            if (digits < 22) {
+                fraction = fraction * 10.0 + (*p - '0');
+                digits += 1;
+            }
+            p += 1;
+        }
+
+        value += fraction / powers[digits];
+    }
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p += 1;
+
+        bool negativeExponent = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negativeExponent = *p == '-';
+            p += 1;
+        }
+
+        int exponent = 0;
+        while (p < end && *p >= '0' && *p <= '9') {
+            if (exponent < 1000) {
+                exponent = exponent * 10 + (*p - '0');
+            }
+            p += 1;
+        }
+
+        double scale = exponent <= 22 ? powers[exponent] : pow(10.0, exponent);
+        value = negativeExponent ? value / scale : value * scale;
+    }
+
+    *out = (float) (negative ? -value : value);
+
+    return p;
+}
+
+static const char *obj_parse_int(const char *p, const char *end, int64_t *out) {
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p += 1;
+    }
+
+    int64_t value = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        if (value < INT32_MAX) {
+            value = value * 10 + (*p - '0');
+        }
+        p += 1;
+    }
+
+    *out = negative ? -value : value;
+
+    return p;
+}
+
+// Turns a 1-based (or negative, relative) obj index into a 0-based one
+static uint32_t obj_resolve_index(int64_t index, uint32_t count, uint32_t total, bool *failed) {
+    int64_t resolved = index > 0 ? index - 1 : (int64_t) count + index;
+
+    if (index == 0 || resolved < 0 || resolved >= (int64_t) total) {
+        *failed = true;
+        return 0;
+    }
+
+    return (uint32_t) resolved;
+}
+
+static uint32_t obj_count_face_vertices(const char *p, const char *end) {
+    uint32_t count = 0;
+
+    while (true) {
+        p = obj_skip_spaces(p, end);
+
+        if (p >= end || *p == '#') {
+            return count;
+        }
+
+        count += 1;
+
+        while (p < end && ! obj_is_space(*p)) {
+            p += 1;
+        }
+    }
+}
+
+static void *obj_count_chunk(void *argument) {
+    ObjChunk *chunk = argument;
+    const char *p = chunk->begin;
+
+    while (p < chunk->end) {
+        const char *lineEnd = obj_line_end(p, chunk->end);
+        p = obj_skip_spaces(p, lineEnd);
+
+        if (lineEnd - p >= 2 && p[0] == 'v' && obj_is_space(p[1])) {
+            chunk->positionCount += 1;
+        } else if (lineEnd - p >= 3 && p[0] == 'v' && p[1] == 't' && obj_is_space(p[2])) {
+            chunk->texcoordCount += 1;
+        } else if (lineEnd - p >= 3 && p[0] == 'v' && p[1] == 'n' && obj_is_space(p[2])) {
+            chunk->normalCount += 1;
+        } else if (lineEnd - p >= 2 && p[0] == 'f' && obj_is_space(p[1])) {
+            uint32_t faceVertices = obj_count_face_vertices(p + 2, lineEnd);
+
+            if (faceVertices >= 3) {
+                chunk->cornerCount += (faceVertices - 2) * 3;
+            }
+        }
+
+        p = lineEnd < chunk->end ? lineEnd + 1 : chunk->end;
+    }
+
+    return NULL;
+}
+
+static void *obj_parse_chunk(void *argument) {
+    ObjChunk *chunk = argument;
+    ObjData *data = chunk->data;
+
+    uint32_t positionIndex = chunk->positionBase;
+    uint32_t texcoordIndex = chunk->texcoordBase;
+    uint32_t normalIndex = chunk->normalBase;
+    uint32_t cornerIndex = chunk->cornerBase;
+
+    const char *p = chunk->begin;
+
+    while (p < chunk->end) {
+        const char *lineEnd = obj_line_end(p, chunk->end);
+        p = obj_skip_spaces(p, lineEnd);
+
+        if (lineEnd - p >= 2 && p[0] == 'v' && obj_is_space(p[1])) {
+            float *position = data->positions[positionIndex];
+            p = obj_parse_float(p + 2, lineEnd, &position[0]);
+            p = obj_parse_float(p, lineEnd, &position[1]);
+            obj_parse_float(p, lineEnd, &position[2]);
+            positionIndex += 1;
+        } else if (lineEnd - p >= 3 && p[0] == 'v' && p[1] == 't' && obj_is_space(p[2])) {
+            float *texcoord = data->texcoords[texcoordIndex];
+            p = obj_parse_float(p + 3, lineEnd, &texcoord[0]);
+            obj_parse_float(p, lineEnd, &texcoord[1]);
+            texcoordIndex += 1;
+        } else if (lineEnd - p >= 3 && p[0] == 'v' && p[1] == 'n' && obj_is_space(p[2])) {
+            float *normal = data->normals[normalIndex];
+            p = obj_parse_float(p + 3, lineEnd, &normal[0]);
+            p = obj_parse_float(p, lineEnd, &normal[1]);
+            obj_parse_float(p, lineEnd, &normal[2]);
+            normalIndex += 1;
+        } else if (lineEnd - p >= 2 && p[0] == 'f' && obj_is_space(p[1])) {
+            ObjCorner first = {0}, previous = {0};
+            uint32_t faceVertex = 0;
+
+            p += 2;
+
+            while (true) {
+                p = obj_skip_spaces(p, lineEnd);
+
+                if (p >= lineEnd || *p == '#') {
+                    break;
+                }
+
+                ObjCorner corner = {
+                    .position = MESH_NO_INDEX,
+                    .texcoord = MESH_NO_INDEX,
+                    .normal = MESH_NO_INDEX,
+                };
+
+                int64_t index;
+                p = obj_parse_int(p, lineEnd, &index);
+                corner.position = obj_resolve_index(index, positionIndex, data->positionCount, &chunk->failed);
+
+                if (p < lineEnd && *p == '/') {
+                    p += 1;
+
+                    if (p < lineEnd && *p != '/' && ! obj_is_space(*p)) {
+                        p = obj_parse_int(p, lineEnd, &index);
+                        corner.texcoord = obj_resolve_index(index, texcoordIndex, data->texcoordCount, &chunk->failed);
+                    }
+
+                    if (p < lineEnd && *p == '/') {
+                        p = obj_parse_int(p + 1, lineEnd, &index);
+                        corner.normal = obj_resolve_index(index, normalIndex, data->normalCount, &chunk->failed);
+                    }
+                }
+
+                while (p < lineEnd && ! obj_is_space(*p)) {
+                    p += 1;
+                }
+
+                // Triangulate polygons as a fan around their first vertex
+                if (faceVertex == 0) {
+                    first = corner;
+                } else if (faceVertex >= 2) {
+                    data->corners[cornerIndex + 0] = first;
+                    data->corners[cornerIndex + 1] = previous;
+                    data->corners[cornerIndex + 2] = corner;
+                    cornerIndex += 3;
+                }
+
+                previous = corner;
+                faceVertex += 1;
+            }
+        }
+
+        p = lineEnd < chunk->end ? lineEnd + 1 : chunk->end;
+    }
+
+    return NULL;
+}
+
+static ObjData obj_parse(const char *source, size_t length, uint32_t threadCount) {
+    ObjChunk chunks[MESH_MAX_THREADS];
+    ObjData data = {0};
+
+    // Don't bother splitting tiny files
+    if ((size_t) threadCount * 4096 > length) {
+        threadCount = (uint32_t) (length / 4096) + 1;
+    }
+
+    const char *end = source + length;
+    const char *begin = source;
+
+    for (uint32_t i = 0; i < threadCount; i += 1) {
+        const char *chunkEnd = i + 1 == threadCount ? end : source + length / threadCount * (i + 1);
+
+        if (chunkEnd < begin) {
+            chunkEnd = begin;
+        }
+
+        if (chunkEnd < end) {
+            chunkEnd = obj_line_end(chunkEnd, end);
+            chunkEnd = chunkEnd < end ? chunkEnd + 1 : end;
+        }
+
+        chunks[i] = (ObjChunk) {
+            .begin = begin,
+            .end = chunkEnd,
+            .data = &data,
+        };
+
+        begin = chunkEnd;
+    }
+
+    mesh_run_threads(obj_count_chunk, chunks, threadCount);
+
+    for (uint32_t i = 0; i < threadCount; i += 1) {
+        chunks[i].positionBase = data.positionCount;
+        chunks[i].texcoordBase = data.texcoordCount;
+        chunks[i].normalBase = data.normalCount;
+        chunks[i].cornerBase = data.cornerCount;
+
+        data.positionCount += chunks[i].positionCount;
+        data.texcoordCount += chunks[i].texcoordCount;
+        data.normalCount += chunks[i].normalCount;
+        data.cornerCount += chunks[i].cornerCount;
+    }
+
+    data.positions = malloc(sizeof(data.positions[0]) * (data.positionCount + 1));
+    data.texcoords = malloc(sizeof(data.texcoords[0]) * (data.texcoordCount + 1));
+    data.normals = malloc(sizeof(data.normals[0]) * (data.normalCount + 1));
+    data.corners = malloc(sizeof(data.corners[0]) * (data.cornerCount + 1));
+
+    if (! data.positions || ! data.texcoords || ! data.normals || ! data.corners) {
+        fprintf(stderr, "[ERROR]: Out of memory while parsing obj!");
+        exit(EXIT_FAILURE);
+    }
+
+    mesh_run_threads(obj_parse_chunk, chunks, threadCount);
+
+    for (uint32_t i = 0; i < threadCount; i += 1) {
+        if (chunks[i].failed) {
+            fprintf(stderr, "[ERROR]: Obj file references an out of range vertex!");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    return data;
+}
+
+static void obj_destroy(ObjData data) {
+    free(data.positions);
+    free(data.texcoords);
+    free(data.normals);
+    free(data.corners);
+}
+
+// Vertex deduplication
+
+static uint32_t mesh_hash_corner(ObjCorner corner) {
+    uint32_t hash = corner.position * 0x9e3779b1u;
+    hash ^= corner.texcoord * 0x85ebca77u + (hash << 6) + (hash >> 2);
+    hash ^= corner.normal * 0xc2b2ae3du + (hash << 6) + (hash >> 2);
+    hash ^= hash >> 15;
+    hash *= 0x2c1b3c6du;
+    hash ^= hash >> 12;
+
+    return hash;
+}
+
+static MeshVertex *mesh_dedup(const ObjData *data, uint32_t *indices, uint32_t *vertexCount) {
+    uint32_t capacity = 16;
+    while (capacity < data->cornerCount * 2) {
+        capacity *= 2;
+    }
+
+    uint32_t *table = malloc(sizeof(uint32_t) * capacity);
+    ObjCorner *unique = malloc(sizeof(ObjCorner) * (data->cornerCount + 1));
+
+    if (! table || ! unique) {
+        fprintf(stderr, "[ERROR]: Out of memory while deduplicating vertices!");
+        exit(EXIT_FAILURE);
+    }
+
+    memset(table, 0xff, sizeof(uint32_t) * capacity);
+
+    uint32_t count = 0;
+
+    for (uint32_t i = 0; i < data->cornerCount; i += 1) {
+        ObjCorner corner = data->corners[i];
+        uint32_t slot = mesh_hash_corner(corner) & (capacity - 1);
+
+        // Linear probing, the table is at most half full
+        while (true) {
+            uint32_t vertex = table[slot];
+
+            if (vertex == MESH_NO_INDEX) {
+                table[slot] = count;
+                unique[count] = corner;
+                indices[i] = count;
+                count += 1;
+                break;
+            }
+
+            if (memcmp(&unique[vertex], &corner, sizeof(ObjCorner)) == 0) {
+                indices[i] = vertex;
+                break;
+            }
+
+            slot = (slot + 1) & (capacity - 1);
+        }
+    }
+
+    free(table);
+
+    MeshVertex *vertices = malloc(sizeof(MeshVertex) * (count + 1));
+
+    if (! vertices) {
+        fprintf(stderr, "[ERROR]: Out of memory while deduplicating vertices!");
+        exit(EXIT_FAILURE);
+    }
+
+    for (uint32_t i = 0; i < count; i += 1) {
+        ObjCorner corner = unique[i];
+        MeshVertex *vertex = &vertices[i];
+
+        memcpy(vertex->position, data->positions[corner.position], sizeof(vertex->position));
+
+        if (corner.normal != MESH_NO_INDEX) {
+            memcpy(vertex->normal, data->normals[corner.normal], sizeof(vertex->normal));
+        } else {
+            memset(vertex->normal, 0, sizeof(vertex->normal));
+        }
+
+        if (corner.texcoord != MESH_NO_INDEX) {
+            memcpy(vertex->uv, data->texcoords[corner.texcoord], sizeof(vertex->uv));
+        } else {
+            memset(vertex->uv, 0, sizeof(vertex->uv));
+        }
+    }
+
+    free(unique);
+    *vertexCount = count;
+
+    return vertices;
+}
+
+// Post-transform vertex cache optimization using Tipsify
+// (Sander, Nehab, Barczak - "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw")
+
+static void mesh_optimize_vertex_cache(uint32_t *indices, uint32_t indexCount, uint32_t vertexCount) {
+    uint32_t triangleCount = indexCount / 3;
+
+    uint32_t *liveTriangles = calloc(vertexCount + 1, sizeof(uint32_t));
+    uint32_t *adjacencyOffsets = calloc(vertexCount + 1, sizeof(uint32_t));
+    uint32_t *adjacency = malloc(sizeof(uint32_t) * (indexCount + 1));
+    uint32_t *cacheTime = calloc(vertexCount + 1, sizeof(uint32_t));
+    uint32_t *deadEnds = malloc(sizeof(uint32_t) * (indexCount + 1));
+    uint32_t *candidates = malloc(sizeof(uint32_t) * (indexCount + 1));
+    bool *emitted = calloc(triangleCount + 1, sizeof(bool));
+    uint32_t *output = malloc(sizeof(uint32_t) * (indexCount + 1));
+
+    if (! liveTriangles || ! adjacencyOffsets || ! adjacency || ! cacheTime ||
+        ! deadEnds || ! candidates || ! emitted || ! output) {
+        fprintf(stderr, "[ERROR]: Out of memory while optimizing mesh!");
+        exit(EXIT_FAILURE);
+    }
+
+    for (uint32_t i = 0; i < indexCount; i += 1) {
+        liveTriangles[indices[i]] += 1;
+    }
+
+    uint32_t offset = 0;
+    for (uint32_t v = 0; v < vertexCount; v += 1) {
+        adjacencyOffsets[v] = offset;
+        offset += liveTriangles[v];
+    }
+    adjacencyOffsets[vertexCount] = offset;
+
+    // Reuse cacheTime as the fill cursor while building the adjacency lists
+    for (uint32_t i = 0; i < indexCount; i += 1) {
+        uint32_t v = indices[i];
+        adjacency[adjacencyOffsets[v] + cacheTime[v]] = i / 3;
+        cacheTime[v] += 1;
+    }
+    memset(cacheTime, 0, sizeof(uint32_t) * vertexCount);
+
+    uint32_t deadEndCount = 0;
+    uint32_t outputCount = 0;
+    uint32_t timestamp = MESH_VERTEX_CACHE_SIZE + 1;
+    uint32_t cursor = 1;
+    uint32_t fanning = vertexCount > 0 ? 0 : MESH_NO_INDEX;
+
+    while (fanning != MESH_NO_INDEX) {
+        uint32_t candidateCount = 0;
+
+        for (uint32_t a = adjacencyOffsets[fanning]; a < adjacencyOffsets[fanning + 1]; a += 1) {
+            uint32_t triangle = adjacency[a];
+
+            if (emitted[triangle]) {
+                continue;
+            }
+
+            for (uint32_t k = 0; k < 3; k += 1) {
+                uint32_t v = indices[triangle * 3 + k];
+
+                output[outputCount] = v;
+                outputCount += 1;
+                deadEnds[deadEndCount] = v;
+                deadEndCount += 1;
+                candidates[candidateCount] = v;
+                candidateCount += 1;
+                liveTriangles[v] -= 1;
+
+                if (timestamp - cacheTime[v] > MESH_VERTEX_CACHE_SIZE) {
+                    cacheTime[v] = timestamp;
+                    timestamp += 1;
+                }
+            }
+
+            emitted[triangle] = true;
+        }
+
+        // Prefer the candidate that will still be in the cache after its remaining triangles are emitted
+        uint32_t next = MESH_NO_INDEX;
+        uint32_t bestPriority = 0;
+
+        for (uint32_t c = 0; c < candidateCount; c += 1) {
+            uint32_t v = candidates[c];
+
+            if (liveTriangles[v] == 0) {
+                continue;
+            }
+
+            uint32_t priority = 1;
+            if (timestamp - cacheTime[v] + 2 * liveTriangles[v] <= MESH_VERTEX_CACHE_SIZE) {
+                priority = timestamp - cacheTime[v] + 1;
+            }
+
+            if (next == MESH_NO_INDEX || priority > bestPriority) {
+                bestPriority = priority;
+                next = v;
+            }
+        }
+
+        if (next == MESH_NO_INDEX) {
+            while (deadEndCount > 0) {
+                deadEndCount -= 1;
+                uint32_t v = deadEnds[deadEndCount];
+
+                if (liveTriangles[v] > 0) {
+                    next = v;
+                    break;
+                }
+            }
+        }
+
+        while (next == MESH_NO_INDEX && cursor < vertexCount) {
+            if (liveTriangles[cursor] > 0) {
+                next = cursor;
+            }
+
+            cursor += 1;
+        }
+
+        fanning = next;
+    }
+
+    memcpy(indices, output, sizeof(uint32_t) * outputCount);
+
+    free(liveTriangles);
+    free(adjacencyOffsets);
+    free(adjacency);
+    free(cacheTime);
+    free(deadEnds);
+    free(candidates);
+    free(emitted);
+    free(output);
+}
+
+// Renumbers vertices in the order the index buffer first touches them so fetches stay sequential
+static void mesh_optimize_vertex_fetch(MeshVertex *vertices, uint32_t vertexCount, uint32_t *indices, uint32_t indexCount) {
+    uint32_t *remap = malloc(sizeof(uint32_t) * (vertexCount + 1));
+    MeshVertex *reordered = malloc(sizeof(MeshVertex) * (vertexCount + 1));
+
+    if (! remap || ! reordered) {
+        fprintf(stderr, "[ERROR]: Out of memory while optimizing mesh!");
+        exit(EXIT_FAILURE);
+    }
+
+    memset(remap, 0xff, sizeof(uint32_t) * vertexCount);
+
+    uint32_t next = 0;
+    for (uint32_t i = 0; i < indexCount; i += 1) {
+        uint32_t v = indices[i];
+
+        if (remap[v] == MESH_NO_INDEX) {
+            remap[v] = next;
+            reordered[next] = vertices[v];
+            next += 1;
+        }
+
+        indices[i] = remap[v];
+    }
+
+    memcpy(vertices, reordered, sizeof(MeshVertex) * next);
+
+    free(remap);
+    free(reordered);
+}
+
+// Quantization
+
+static uint16_t mesh_float_to_half(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000;
+    uint32_t biasedExponent = (bits >> 23) & 0xff;
+    uint32_t mantissa = bits & 0x7fffff;
+    int32_t exponent = (int32_t) biasedExponent - 127 + 15;
+
+    if (biasedExponent == 0xff) {
+        return (uint16_t) (sign | 0x7c00 | (mantissa ? 0x200 : 0));
+    }
+
+    if (exponent >= 31) {
+        return (uint16_t) (sign | 0x7c00);
+    }
+
+    if (exponent <= 0) {
+        if (exponent < -10) {
+            return (uint16_t) sign;
+        }
+
+        mantissa |= 0x800000;
+        uint32_t shift = (uint32_t) (14 - exponent);
+        uint32_t half = mantissa >> shift;
+        uint32_t rest = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+
+        if (rest > halfway || (rest == halfway && (half & 1))) {
+            half += 1;
+        }
+
+        return (uint16_t) (sign | half);
+    }
+
+    uint32_t half = sign | ((uint32_t) exponent << 10) | (mantissa >> 13);
+    uint32_t rest = mantissa & 0x1fff;
+
+    // Rounding may carry into the exponent, which is exactly what we want
+    if (rest > 0x1000 || (rest == 0x1000 && (half & 1))) {
+        half += 1;
+    }
+
+    return (uint16_t) half;
+}
+
+static uint16_t mesh_quantize_unorm16(float value, float min, float extent) {
+    if (extent <= 0.0f) {
+        return 0;
+    }
+
+    float normalized = (value - min) / extent;
+    normalized = normalized < 0.0f ? 0.0f : (normalized > 1.0f ? 1.0f : normalized);
+
+    return (uint16_t) (normalized * 65535.0f + 0.5f);
+}
+
+static int8_t mesh_quantize_snorm8(float value) {
+    value = value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+
+    return (int8_t) lroundf(value * 127.0f);
+}
+
+static MeshQuantizedVertex *mesh_quantize(const MeshVertex *vertices, uint32_t vertexCount, const float boundsMin[3], const float boundsMax[3]) {
+    MeshQuantizedVertex *quantized = malloc(sizeof(MeshQuantizedVertex) * (vertexCount + 1));
+
+    if (! quantized) {
+        fprintf(stderr, "[ERROR]: Out of memory while quantizing mesh!");
+        exit(EXIT_FAILURE);
+    }
+
+    for (uint32_t i = 0; i < vertexCount; i += 1) {
+        const MeshVertex *vertex = &vertices[i];
+        MeshQuantizedVertex *out = &quantized[i];
+
+        for (uint32_t k = 0; k < 3; k += 1) {
+            out->position[k] = mesh_quantize_unorm16(vertex->position[k], boundsMin[k], boundsMax[k] - boundsMin[k]);
+            out->normal[k] = mesh_quantize_snorm8(vertex->normal[k]);
+        }
+
+        out->position[3] = 65535;
+        out->normal[3] = 0;
+        out->uv[0] = mesh_float_to_half(vertex->uv[0]);
+        out->uv[1] = mesh_float_to_half(vertex->uv[1]);
+    }
+
+    return quantized;
+}
+
+Mesh mesh_load_obj(const char *path, MeshLoadOptions options) {
+    size_t length = 0;
+    const char *source = mesh_map_file(path, &length);
+
+    if (source == NULL) {
+        perror("Failed to map obj file");
+        exit(EXIT_FAILURE);
+    }
+
+    posix_madvise((void *) source, length, POSIX_MADV_SEQUENTIAL);
+
+    ObjData data = obj_parse(source, length, mesh_thread_count(options.threadCount));
+    munmap((void *) source, length);
+
+    uint32_t indexCount = data.cornerCount;
+    uint32_t *indices = malloc(sizeof(uint32_t) * (indexCount + 1));
+
+    if (! indices) {
+        fprintf(stderr, "[ERROR]: Out of memory while loading obj!");
+        exit(EXIT_FAILURE);
+    }
+
+    uint32_t vertexCount = 0;
+    MeshVertex *vertices = mesh_dedup(&data, indices, &vertexCount);
+    obj_destroy(data);
+
+    if (options.optimize) {
+        mesh_optimize_vertex_cache(indices, indexCount, vertexCount);
+        mesh_optimize_vertex_fetch(vertices, vertexCount, indices, indexCount);
+    }
+
+    Mesh mesh = {
+        .vertexCount = vertexCount,
+        .indexCount = indexCount,
+        .indexSize = sizeof(uint32_t),
+        .optimized = options.optimize,
+        .boundsMin = { 0.0f, 0.0f, 0.0f },
+        .boundsMax = { 0.0f, 0.0f, 0.0f },
+    };
+
+    for (uint32_t i = 0; i < vertexCount; i += 1) {
+        for (uint32_t k = 0; k < 3; k += 1) {
+            float value = vertices[i].position[k];
+
+            if (i == 0 || value < mesh.boundsMin[k]) {
+                mesh.boundsMin[k] = value;
+            }
+
+            if (i == 0 || value > mesh.boundsMax[k]) {
+                mesh.boundsMax[k] = value;
+            }
+        }
+    }
+
+    if (options.quantize) {
+        mesh.vertices = mesh_quantize(vertices, vertexCount, mesh.boundsMin, mesh.boundsMax);
+        mesh.vertexStride = sizeof(MeshQuantizedVertex);
+        mesh.quantized = true;
+        free(vertices);
+    } else {
+        mesh.vertices = vertices;
+        mesh.vertexStride = sizeof(MeshVertex);
+    }
+
+    // Narrow the indices in place when every vertex is addressable with 16 bits
+    if (vertexCount <= UINT16_MAX + 1) {
+        uint16_t *narrow = (uint16_t *) indices;
+
+        for (uint32_t i = 0; i < indexCount; i += 1) {
+            narrow[i] = (uint16_t) indices[i];
+        }
+
+        mesh.indexSize = sizeof(uint16_t);
+    }
+
+    mesh.indices = indices;
+
+    return mesh;
+}
+
+// Binary cache
+
+static size_t mesh_align(size_t value) {
+    return (value + MESH_CACHE_ALIGNMENT - 1) & ~(size_t) (MESH_CACHE_ALIGNMENT - 1);
+}
+
+static bool mesh_map_cache_for(const char *path, Mesh *mesh, const struct stat *source) {
+    size_t length = 0;
+    char *data = mesh_map_file(path, &length);
+
+    if (data == NULL) {
+        return false;
+    }
+
+    const MeshCacheHeader *header = (const MeshCacheHeader *) data;
+
+    bool valid = length >= sizeof(MeshCacheHeader) &&
+        header->magic == MESH_CACHE_MAGIC &&
+        header->version == MESH_CACHE_VERSION &&
+        (header->indexSize == 2 || header->indexSize == 4) &&
+        header->vertexStride == ((header->flags & MESH_CACHE_QUANTIZED) ? sizeof(MeshQuantizedVertex) : sizeof(MeshVertex)) &&
+        header->vertexOffset <= length &&
+        header->indexOffset <= length &&
+        (uint64_t) header->vertexCount * header->vertexStride <= length - header->vertexOffset &&
+        (uint64_t) header->indexCount * header->indexSize <= length - header->indexOffset;
+
+    if (valid && source != NULL) {
+        valid = header->sourceSize == (uint64_t) source->st_size &&
+            header->sourceModified == (int64_t) source->st_mtim.tv_sec &&
+            header->sourceModifiedNanoseconds == (uint32_t) source->st_mtim.tv_nsec;
+    }
+
+    if (! valid) {
+        munmap(data, length);
+        return false;
+    }
+
+    *mesh = (Mesh) {
+        .vertices = data + header->vertexOffset,
+        .indices = data + header->indexOffset,
+        .vertexCount = header->vertexCount,
+        .vertexStride = header->vertexStride,
+        .indexCount = header->indexCount,
+        .indexSize = header->indexSize,
+        .quantized = (header->flags & MESH_CACHE_QUANTIZED) != 0,
+        .optimized = (header->flags & MESH_CACHE_OPTIMIZED) != 0,
+        .mapping = data,
+        .mappingLength = length,
+    };
+
+    memcpy(mesh->boundsMin, header->boundsMin, sizeof(mesh->boundsMin));
+    memcpy(mesh->boundsMax, header->boundsMax, sizeof(mesh->boundsMax));
+
+    return true;
+}
+
+bool mesh_map_cache(const char *path, Mesh *mesh) {
+    return mesh_map_cache_for(path, mesh, NULL);
+}
+
+bool mesh_write_cache(const Mesh *mesh, const char *path, const char *sourcePath) {
+    struct stat source = {0};
+
+    if (sourcePath != NULL && stat(sourcePath, &source) != 0) {
+        return false;
+    }
+
+    size_t vertexBytes = (size_t) mesh->vertexCount * mesh->vertexStride;
+    size_t indexBytes = (size_t) mesh->indexCount * mesh->indexSize;
+    size_t vertexOffset = mesh_align(sizeof(MeshCacheHeader));
+    size_t indexOffset = mesh_align(vertexOffset + vertexBytes);
+
+    MeshCacheHeader header = {
+        .magic = MESH_CACHE_MAGIC,
+        .version = MESH_CACHE_VERSION,
+        .flags = (mesh->quantized ? MESH_CACHE_QUANTIZED : 0) | (mesh->optimized ? MESH_CACHE_OPTIMIZED : 0),
+        .vertexStride = mesh->vertexStride,
+        .vertexCount = mesh->vertexCount,
+        .indexCount = mesh->indexCount,
+        .indexSize = mesh->indexSize,
+        .sourceSize = (uint64_t) source.st_size,
+        .sourceModified = (int64_t) source.st_mtim.tv_sec,
+        .sourceModifiedNanoseconds = (uint32_t) source.st_mtim.tv_nsec,
+        .vertexOffset = vertexOffset,
+        .indexOffset = indexOffset,
+    };
+
+    memcpy(header.boundsMin, mesh->boundsMin, sizeof(header.boundsMin));
+    memcpy(header.boundsMax, mesh->boundsMax, sizeof(header.boundsMax));
+
+    // Write next to the cache and rename over it, so meshes still mapping the old file keep their data
+    size_t pathLength = strlen(path);
+    char *temporaryPath = malloc(pathLength + sizeof(".tmp"));
+
+    if (temporaryPath == NULL) {
+        return false;
+    }
+
+    memcpy(temporaryPath, path, pathLength);
+    memcpy(temporaryPath + pathLength, ".tmp", sizeof(".tmp"));
+
+    FILE *fd = fopen(temporaryPath, "wb");
+
+    if (fd == NULL) {
+        free(temporaryPath);
+        return false;
+    }
+
+    static const char padding[MESH_CACHE_ALIGNMENT] = {0};
+
+    bool written = fwrite(&header, sizeof(header), 1, fd) == 1 &&
+        fwrite(padding, 1, vertexOffset - sizeof(header), fd) == vertexOffset - sizeof(header) &&
+        fwrite(mesh->vertices, 1, vertexBytes, fd) == vertexBytes &&
+        fwrite(padding, 1, indexOffset - vertexOffset - vertexBytes, fd) == indexOffset - vertexOffset - vertexBytes &&
+        fwrite(mesh->indices, 1, indexBytes, fd) == indexBytes;
+
+    if (fclose(fd) != 0 || ! written || rename(temporaryPath, path) != 0) {
+        remove(temporaryPath);
+        free(temporaryPath);
+        return false;
+    }
+
+    free(temporaryPath);
+
+    return true;
+}
+
+Mesh mesh_load(const char *sourcePath, const char *cachePath, MeshLoadOptions options) {
+    struct stat source;
+
+    if (stat(sourcePath, &source) != 0) {
+        perror("Failed to stat mesh source");
+        exit(EXIT_FAILURE);
+    }
+
+    Mesh mesh;
+
+    if (mesh_map_cache_for(cachePath, &mesh, &source)) {
+        if (mesh.quantized == options.quantize && mesh.optimized == options.optimize) {
+            return mesh;
+        }
+
+        mesh_destroy(mesh);
+    }
+
+    mesh = mesh_load_obj(sourcePath, options);
+
+    if (! mesh_write_cache(&mesh, cachePath, sourcePath)) {
+        fprintf(stderr, "[WARNING]: Failed to write mesh cache %s\n", cachePath);
+    }
+
+    return mesh;
+}
+
+void mesh_destroy(Mesh mesh) {
+    if (mesh.mapping != NULL) {
+        munmap(mesh.mapping, mesh.mappingLength);
+        return;
+    }
+
+    free((void *) mesh.vertices);
+    free((void *) mesh.indices);
+}
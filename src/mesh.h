@@ -0,0 +1,64 @@
+#ifndef MESH
+#define MESH
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Full precision vertex, 32 bytes
+// position: VK_FORMAT_R32G32B32_SFLOAT
+// normal:   VK_FORMAT_R32G32B32_SFLOAT
+// uv:       VK_FORMAT_R32G32_SFLOAT
+typedef struct MeshVertex {
+    float position[3];
+    float normal[3];
+    float uv[2];
+} MeshVertex;
+
+// Quantized vertex, 16 bytes
+// position: VK_FORMAT_R16G16B16A16_UNORM, relative to the mesh bounds
+// normal:   VK_FORMAT_R8G8B8A8_SNORM
+// uv:       VK_FORMAT_R16G16_SFLOAT
+typedef struct MeshQuantizedVertex {
+    uint16_t position[4];
+    int8_t normal[4];
+    uint16_t uv[2];
+} MeshQuantizedVertex;
+
+typedef struct Mesh {
+    // Either MeshVertex or MeshQuantizedVertex depending on `quantized`
+    const void *vertices;
+    // uint16_t when indexSize is 2, uint32_t when it's 4
+    const void *indices;
+    uint32_t vertexCount;
+    uint32_t vertexStride;
+    uint32_t indexCount;
+    uint32_t indexSize;
+    bool quantized;
+    bool optimized;
+    float boundsMin[3];
+    float boundsMax[3];
+
+    // Set when the mesh points straight into a memory mapped cache file
+    void *mapping;
+    size_t mappingLength;
+} Mesh;
+
+typedef struct MeshLoadOptions {
+    // 0 picks the number of online cpus
+    uint32_t threadCount;
+    bool optimize;
+    bool quantize;
+} MeshLoadOptions;
+
+// Parses a wavefront obj file, dedups its vertices and (optionally) optimizes and quantizes the result
+Mesh mesh_load_obj(const char *path, MeshLoadOptions options);
+
+// Maps a cache written by mesh_write_cache, returns false if it is missing or invalid
+bool mesh_map_cache(const char *path, Mesh *mesh);
+bool mesh_write_cache(const Mesh *mesh, const char *path, const char *sourcePath);
+
+// Maps the cache if it's still valid for sourcePath, otherwise imports the obj and rewrites the cache
+Mesh mesh_load(const char *sourcePath, const char *cachePath, MeshLoadOptions options);
+
+void mesh_destroy(Mesh mesh);
+#endif
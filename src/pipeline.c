@@ -0,0 +1,384 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include "mesh.h"
+#include "pipeline.h"
+
+#define PIPELINE_CACHE_MIN_CAPACITY 16
+
+PipelineState pipeline_state_default(
+    VkShaderModule vertexShader,
+    VkShaderModule fragmentShader,
+    VkPipelineLayout layout,
+    VkRenderPass renderPass
+) {
+    PipelineState state;
+    memset(&state, 0, sizeof(state));
+
+    state.vertexShader = vertexShader;
+    state.fragmentShader = fragmentShader;
+    state.layout = layout;
+    state.renderPass = renderPass;
+    state.subpass = 0;
+
+    state.vertexFormat = PIPELINE_VERTEX_FORMAT_NONE;
+    state.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+    state.polygonMode = VK_POLYGON_MODE_FILL;
+    state.cullMode = VK_CULL_MODE_BACK_BIT;
+    state.frontFace = VK_FRONT_FACE_CLOCKWISE;
+    state.samples = VK_SAMPLE_COUNT_1_BIT;
+
+    state.blendEnable = VK_FALSE;
+    state.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+    state.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+    state.colorBlendOp = VK_BLEND_OP_ADD;
+    state.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+    state.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+    state.alphaBlendOp = VK_BLEND_OP_ADD;
+    state.colorWriteMask = VK_COLOR_COMPONENT_R_BIT |
+                           VK_COLOR_COMPONENT_G_BIT |
+                           VK_COLOR_COMPONENT_B_BIT |
+                           VK_COLOR_COMPONENT_A_BIT;
+
+    return state;
+}
+
+void pipeline_state_specialize(PipelineState *state, uint32_t constantId, uint32_t value) {
+    for (uint32_t i = 0; i < state->specializationCount; i += 1) {
+        if (state->specializationIds[i] == constantId) {
+            state->specializationValues[i] = value;
+            return;
+        }
+    }
+
+    if (state->specializationCount == PIPELINE_MAX_SPECIALIZATION_CONSTANTS) {
+        fprintf(stderr, "[ERROR]: Too many specialization constants!");
+        exit(EXIT_FAILURE);
+    }
+
+    // Keep the constants sorted by id so the order they were set in doesn't change the hash
+    uint32_t i = state->specializationCount;
+    while (i > 0 && state->specializationIds[i - 1] > constantId) {
+        state->specializationIds[i] = state->specializationIds[i - 1];
+        state->specializationValues[i] = state->specializationValues[i - 1];
+        i -= 1;
+    }
+
+    state->specializationIds[i] = constantId;
+    state->specializationValues[i] = value;
+    state->specializationCount += 1;
+}
+
+uint64_t pipeline_state_hash(const PipelineState *state) {
+    // FNV-1a over 32-bit words, PipelineState has no padding and its size is a multiple of 4
+    const unsigned char *bytes = (const unsigned char *) state;
+    uint64_t hash = 0xcbf29ce484222325ull;
+
+    for (size_t offset = 0; offset < sizeof(PipelineState); offset += sizeof(uint32_t)) {
+        uint32_t word;
+        memcpy(&word, bytes + offset, sizeof(word));
+
+        hash ^= word;
+        hash *= 0x100000001b3ull;
+    }
+
+    // FNV's low bits only depend on the low bits of each word, the table masks the
+    // low bits, so fold the high bits down with murmur3's finalizer
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33;
+
+    // Zero marks an empty slot in the table
+    return hash == 0 ? 1 : hash;
+}
+
+static PipelineCacheEntry *pipeline_cache_slot(PipelineCacheEntry *entries, uint32_t capacity, const PipelineState *state, uint64_t hash) {
+    uint32_t slot = (uint32_t) hash & (capacity - 1);
+
+    while (true) {
+        PipelineCacheEntry *entry = &entries[slot];
+
+        if (entry->hash == 0) {
+            return entry;
+        }
+
+        if (entry->hash == hash && memcmp(&entry->state, state, sizeof(PipelineState)) == 0) {
+            return entry;
+        }
+
+        slot = (slot + 1) & (capacity - 1);
+    }
+}
+
+static void pipeline_cache_grow(PipelineCache *cache) {
+    uint32_t capacity = cache->capacity * 2;
+    PipelineCacheEntry *entries = calloc(capacity, sizeof(PipelineCacheEntry));
+
+    if (entries == NULL) {
+        fprintf(stderr, "[ERROR]: Failed to grow pipeline cache!");
+        exit(EXIT_FAILURE);
+    }
+
+    for (uint32_t i = 0; i < cache->capacity; i += 1) {
+        PipelineCacheEntry *entry = &cache->entries[i];
+
+        if (entry->hash != 0) {
+            *pipeline_cache_slot(entries, capacity, &entry->state, entry->hash) = *entry;
+        }
+    }
+
+    free(cache->entries);
+    cache->entries = entries;
+    cache->capacity = capacity;
+}
+
+PipelineCache pipeline_cache_create(VkDevice device, uint32_t capacity) {
+    uint32_t tableCapacity = PIPELINE_CACHE_MIN_CAPACITY;
+    while (tableCapacity < capacity * 2) {
+        tableCapacity *= 2;
+    }
+
+    PipelineCache cache = {
+        .device = device,
+        .driverCache = VK_NULL_HANDLE,
+        .entries = calloc(tableCapacity, sizeof(PipelineCacheEntry)),
+        .capacity = tableCapacity,
+        .count = 0,
+    };
+
+    if (cache.entries == NULL) {
+        fprintf(stderr, "[ERROR]: Failed to allocate pipeline cache!");
+        exit(EXIT_FAILURE);
+    }
+
+    VkPipelineCacheCreateInfo driverCacheInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .initialDataSize = 0,
+        .pInitialData = NULL,
+    };
+
+    if (vkCreatePipelineCache(device, &driverCacheInfo, NULL, &cache.driverCache) != VK_SUCCESS) {
+        fprintf(stderr, "[ERROR]: Failed to create pipeline cache!");
+        exit(EXIT_FAILURE);
+    }
+
+    return cache;
+}
+
+VkPipeline pipeline_cache_find(const PipelineCache *cache, const PipelineState *state, uint64_t hash) {
+    return pipeline_cache_slot(cache->entries, cache->capacity, state, hash)->pipeline;
+}
+
+static VkPipeline pipeline_create(const PipelineCache *cache, const PipelineState *state) {
+    VkSpecializationMapEntry specializationEntries[PIPELINE_MAX_SPECIALIZATION_CONSTANTS];
+
+    for (uint32_t i = 0; i < state->specializationCount; i += 1) {
+        specializationEntries[i] = (VkSpecializationMapEntry) {
+            .constantID = state->specializationIds[i],
+            .offset = i * sizeof(uint32_t),
+            .size = sizeof(uint32_t),
+        };
+    }
+
+    VkSpecializationInfo specializationInfo = {
+        .mapEntryCount = state->specializationCount,
+        .pMapEntries = specializationEntries,
+        .dataSize = state->specializationCount * sizeof(uint32_t),
+        .pData = state->specializationValues,
+    };
+
+    const VkSpecializationInfo *specialization = state->specializationCount > 0 ? &specializationInfo : NULL;
+
+    const VkPipelineShaderStageCreateInfo shaderStages[] = {
+        {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage = VK_SHADER_STAGE_VERTEX_BIT,
+            .module = state->vertexShader,
+            .pName = "main",
+            .pSpecializationInfo = specialization,
+        },
+        {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+            .module = state->fragmentShader,
+            .pName = "main",
+            .pSpecializationInfo = specialization,
+        },
+    };
+
+    const VkDynamicState dynamicStates[] = {
+        VK_DYNAMIC_STATE_VIEWPORT,
+        VK_DYNAMIC_STATE_SCISSOR,
+    };
+
+    VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+        .dynamicStateCount = sizeof(dynamicStates) / sizeof(dynamicStates[0]),
+        .pDynamicStates = dynamicStates,
+    };
+
+    const VkVertexInputBindingDescription meshBinding = {
+        .binding = 0,
+        .stride = state->vertexFormat == PIPELINE_VERTEX_FORMAT_MESH_QUANTIZED
+            ? sizeof(MeshQuantizedVertex)
+            : sizeof(MeshVertex),
+        .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
+    };
+
+    const VkVertexInputAttributeDescription meshAttributes[] = {
+        { .location = 0, .binding = 0, .format = VK_FORMAT_R32G32B32_SFLOAT, .offset = offsetof(MeshVertex, position) },
+        { .location = 1, .binding = 0, .format = VK_FORMAT_R32G32B32_SFLOAT, .offset = offsetof(MeshVertex, normal) },
+        { .location = 2, .binding = 0, .format = VK_FORMAT_R32G32_SFLOAT, .offset = offsetof(MeshVertex, uv) },
+    };
+
+    const VkVertexInputAttributeDescription quantizedMeshAttributes[] = {
+        { .location = 0, .binding = 0, .format = VK_FORMAT_R16G16B16A16_UNORM, .offset = offsetof(MeshQuantizedVertex, position) },
+        { .location = 1, .binding = 0, .format = VK_FORMAT_R8G8B8A8_SNORM, .offset = offsetof(MeshQuantizedVertex, normal) },
+        { .location = 2, .binding = 0, .format = VK_FORMAT_R16G16_SFLOAT, .offset = offsetof(MeshQuantizedVertex, uv) },
+    };
+
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+        .vertexBindingDescriptionCount = 0,
+        .pVertexBindingDescriptions = NULL,
+        .vertexAttributeDescriptionCount = 0,
+        .pVertexAttributeDescriptions = NULL,
+    };
+
+    if (state->vertexFormat != PIPELINE_VERTEX_FORMAT_NONE) {
+        vertexInputInfo.vertexBindingDescriptionCount = 1;
+        vertexInputInfo.pVertexBindingDescriptions = &meshBinding;
+        vertexInputInfo.vertexAttributeDescriptionCount = 3;
+        vertexInputInfo.pVertexAttributeDescriptions = state->vertexFormat == PIPELINE_VERTEX_FORMAT_MESH_QUANTIZED
+            ? quantizedMeshAttributes
+            : meshAttributes;
+    }
+
+    VkPipelineInputAssemblyStateCreateInfo pipelineInputAssemblyCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+        .topology = state->topology,
+        .primitiveRestartEnable = VK_FALSE,
+    };
+
+    VkPipelineViewportStateCreateInfo viewPortStateCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+        .viewportCount = 1,
+        .scissorCount = 1,
+    };
+
+    VkPipelineRasterizationStateCreateInfo rasterizer = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+        .depthClampEnable = VK_FALSE,
+        .rasterizerDiscardEnable = VK_FALSE,
+        .polygonMode = state->polygonMode,
+        .lineWidth = 1.0f,
+        .cullMode = state->cullMode,
+        .frontFace = state->frontFace,
+        .depthBiasEnable = VK_FALSE,
+        .depthBiasConstantFactor = 0.0f,
+        .depthBiasClamp = 0.0f,
+        .depthBiasSlopeFactor = 0.0f,
+    };
+
+    VkPipelineMultisampleStateCreateInfo multisampling = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+        .sampleShadingEnable = VK_FALSE,
+        .rasterizationSamples = state->samples,
+        .minSampleShading = 1.0f,
+        .pSampleMask = NULL,
+        .alphaToCoverageEnable = VK_FALSE,
+        .alphaToOneEnable = VK_FALSE,
+    };
+
+    VkPipelineColorBlendAttachmentState colorBlendAttachment = {
+        .colorWriteMask = state->colorWriteMask,
+        .blendEnable = state->blendEnable,
+        .srcColorBlendFactor = state->srcColorBlendFactor,
+        .dstColorBlendFactor = state->dstColorBlendFactor,
+        .colorBlendOp = state->colorBlendOp,
+        .srcAlphaBlendFactor = state->srcAlphaBlendFactor,
+        .dstAlphaBlendFactor = state->dstAlphaBlendFactor,
+        .alphaBlendOp = state->alphaBlendOp,
+    };
+
+    VkPipelineColorBlendStateCreateInfo colorBlending = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+        .logicOpEnable = VK_FALSE,
+        .logicOp = VK_LOGIC_OP_COPY,
+        .attachmentCount = 1,
+        .pAttachments = &colorBlendAttachment,
+        .blendConstants = {
+            0.0f,
+            0.0f,
+            0.0f,
+            0.0f,
+        },
+    };
+
+    VkGraphicsPipelineCreateInfo pipelineInfo = {
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+        .stageCount = 2,
+        .pStages = shaderStages,
+        .pVertexInputState = &vertexInputInfo,
+        .pInputAssemblyState = &pipelineInputAssemblyCreateInfo,
+        .pViewportState = &viewPortStateCreateInfo,
+        .pRasterizationState = &rasterizer,
+        .pMultisampleState = &multisampling,
+        .pDepthStencilState = NULL,
+        .pColorBlendState = &colorBlending,
+        .pDynamicState = &dynamicStateCreateInfo,
+        .layout = state->layout,
+        .renderPass = state->renderPass,
+        .subpass = state->subpass,
+        .basePipelineHandle = VK_NULL_HANDLE,
+        .basePipelineIndex = -1,
+    };
+
+    VkPipeline pipeline;
+    if (vkCreateGraphicsPipelines(cache->device, cache->driverCache, 1, &pipelineInfo, NULL, &pipeline) != VK_SUCCESS) {
+        fprintf(stderr, "[ERROR]: Failed to create graphics pipeline!");
+        exit(EXIT_FAILURE);
+    }
+
+    return pipeline;
+}
+
+VkPipeline pipeline_cache_get_hashed(PipelineCache *cache, const PipelineState *state, uint64_t hash) {
+    PipelineCacheEntry *entry = pipeline_cache_slot(cache->entries, cache->capacity, state, hash);
+
+    if (entry->hash != 0) {
+        return entry->pipeline;
+    }
+
+    // Keep the load factor at or below one half so probes stay short
+    if ((cache->count + 1) * 2 > cache->capacity) {
+        pipeline_cache_grow(cache);
+        entry = pipeline_cache_slot(cache->entries, cache->capacity, state, hash);
+    }
+
+    entry->hash = hash;
+    entry->state = *state;
+    entry->pipeline = pipeline_create(cache, state);
+    cache->count += 1;
+
+    return entry->pipeline;
+}
+
+VkPipeline pipeline_cache_get(PipelineCache *cache, const PipelineState *state) {
+    return pipeline_cache_get_hashed(cache, state, pipeline_state_hash(state));
+}
+
+void pipeline_cache_destroy(PipelineCache cache) {
+    for (uint32_t i = 0; i < cache.capacity; i += 1) {
+        if (cache.entries[i].hash != 0) {
+            vkDestroyPipeline(cache.device, cache.entries[i].pipeline, NULL);
+        }
+    }
+
+    vkDestroyPipelineCache(cache.device, cache.driverCache, NULL);
+    free(cache.entries);
+}
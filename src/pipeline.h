@@ -0,0 +1,82 @@
+#ifndef PIPELINE
+#define PIPELINE
+#include <stdbool.h>
+#include <stdint.h>
+#include <vulkan/vulkan_core.h>
+
+#define PIPELINE_MAX_SPECIALIZATION_CONSTANTS 8
+
+typedef enum PipelineVertexFormat {
+    PIPELINE_VERTEX_FORMAT_NONE = 0,
+    PIPELINE_VERTEX_FORMAT_MESH,
+    PIPELINE_VERTEX_FORMAT_MESH_QUANTIZED,
+} PipelineVertexFormat;
+
+// Everything that ends up baked into a VkPipeline. The whole struct is hashed and
+// compared byte for byte, so always start from pipeline_state_default() to keep
+// the padding zeroed.
+typedef struct PipelineState {
+    VkShaderModule vertexShader;
+    VkShaderModule fragmentShader;
+    VkPipelineLayout layout;
+    VkRenderPass renderPass;
+    uint32_t subpass;
+
+    PipelineVertexFormat vertexFormat;
+    VkPrimitiveTopology topology;
+
+    VkPolygonMode polygonMode;
+    VkCullModeFlags cullMode;
+    VkFrontFace frontFace;
+    VkSampleCountFlagBits samples;
+
+    VkBool32 blendEnable;
+    VkBlendFactor srcColorBlendFactor;
+    VkBlendFactor dstColorBlendFactor;
+    VkBlendOp colorBlendOp;
+    VkBlendFactor srcAlphaBlendFactor;
+    VkBlendFactor dstAlphaBlendFactor;
+    VkBlendOp alphaBlendOp;
+    VkColorComponentFlags colorWriteMask;
+
+    // 32-bit specialization constants shared by every stage, stages ignore ids they don't declare
+    uint32_t specializationCount;
+    uint32_t specializationIds[PIPELINE_MAX_SPECIALIZATION_CONSTANTS];
+    uint32_t specializationValues[PIPELINE_MAX_SPECIALIZATION_CONSTANTS];
+} PipelineState;
+
+typedef struct PipelineCacheEntry {
+    uint64_t hash;
+    PipelineState state;
+    VkPipeline pipeline;
+} PipelineCacheEntry;
+
+typedef struct PipelineCache {
+    VkDevice device;
+    VkPipelineCache driverCache;
+    PipelineCacheEntry *entries;
+    uint32_t capacity;
+    uint32_t count;
+} PipelineCache;
+
+PipelineState pipeline_state_default(
+    VkShaderModule vertexShader,
+    VkShaderModule fragmentShader,
+    VkPipelineLayout layout,
+    VkRenderPass renderPass
+);
+void pipeline_state_specialize(PipelineState *state, uint32_t constantId, uint32_t value);
+uint64_t pipeline_state_hash(const PipelineState *state);
+
+// capacity is a hint for the number of distinct pipelines, the table only grows on misses
+PipelineCache pipeline_cache_create(VkDevice device, uint32_t capacity);
+
+// Returns VK_NULL_HANDLE when the state hasn't been created yet, never allocates
+VkPipeline pipeline_cache_find(const PipelineCache *cache, const PipelineState *state, uint64_t hash);
+
+// Looks the state up and creates the pipeline on a miss
+VkPipeline pipeline_cache_get(PipelineCache *cache, const PipelineState *state);
+VkPipeline pipeline_cache_get_hashed(PipelineCache *cache, const PipelineState *state, uint64_t hash);
+
+void pipeline_cache_destroy(PipelineCache cache);
+#endif
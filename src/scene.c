@@ -0,0 +1,688 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include "scene.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define SCENE_SAH_BINS 16
+#define SCENE_LANES 4
+
+typedef enum SceneTest {
+    SCENE_OUTSIDE,
+    SCENE_INTERSECTS,
+    SCENE_INSIDE,
+} SceneTest;
+
+// Building
+
+static void scene_grow(Scene *scene) {
+    uint32_t capacity = scene->objectCapacity == 0 ? 64 : scene->objectCapacity * 2;
+
+    scene->bounds = realloc(scene->bounds, sizeof(SceneAabb) * capacity);
+    scene->draws = realloc(scene->draws, sizeof(SceneDraw) * capacity);
+
+    if (scene->bounds == NULL || scene->draws == NULL) {
+        fprintf(stderr, "[ERROR]: Failed to grow scene!");
+        exit(EXIT_FAILURE);
+    }
+
+    scene->objectCapacity = capacity;
+}
+
+static void scene_free_tree(Scene *scene) {
+    free(scene->slots);
+    free(scene->objects);
+    free(scene->leaves);
+    free(scene->nodes);
+    free(scene->dirtyNodes);
+
+    for (uint32_t k = 0; k < 3; k += 1) {
+        free(scene->centers[k]);
+        free(scene->extents[k]);
+        scene->centers[k] = NULL;
+        scene->extents[k] = NULL;
+    }
+
+    scene->slots = NULL;
+    scene->objects = NULL;
+    scene->leaves = NULL;
+    scene->nodes = NULL;
+    scene->dirtyNodes = NULL;
+    scene->nodeCount = 0;
+}
+
+static float scene_centroid(const SceneAabb *bounds, uint32_t axis) {
+    return (bounds->min[axis] + bounds->max[axis]) * 0.5f;
+}
+
+static void scene_aabb_empty(float min[3], float max[3]) {
+    for (uint32_t k = 0; k < 3; k += 1) {
+        min[k] = INFINITY;
+        max[k] = -INFINITY;
+    }
+}
+
+static void scene_aabb_grow(float min[3], float max[3], const float otherMin[3], const float otherMax[3]) {
+    for (uint32_t k = 0; k < 3; k += 1) {
+        min[k] = otherMin[k] < min[k] ? otherMin[k] : min[k];
+        max[k] = otherMax[k] > max[k] ? otherMax[k] : max[k];
+    }
+}
+
+static float scene_aabb_area(const float min[3], const float max[3]) {
+    float x = max[0] - min[0];
+    float y = max[1] - min[1];
+    float z = max[2] - min[2];
+
+    return x < 0.0f ? 0.0f : x * y + y * z + z * x;
+}
+
+static void scene_build_node(Scene *scene, uint32_t first, uint32_t count) {
+    uint32_t index = scene->nodeCount;
+    scene->nodeCount += 1;
+
+    SceneNode *node = &scene->nodes[index];
+    float centroidMin[3], centroidMax[3];
+
+    scene_aabb_empty(node->min, node->max);
+    scene_aabb_empty(centroidMin, centroidMax);
+
+    for (uint32_t i = first; i < first + count; i += 1) {
+        const SceneAabb *bounds = &scene->bounds[scene->objects[i]];
+        float centroid[3] = {
+            scene_centroid(bounds, 0),
+            scene_centroid(bounds, 1),
+            scene_centroid(bounds, 2),
+        };
+
+        scene_aabb_grow(node->min, node->max, bounds->min, bounds->max);
+        scene_aabb_grow(centroidMin, centroidMax, centroid, centroid);
+    }
+
+    node->first = first;
+    node->count = count;
+
+    uint32_t axis = 0;
+    for (uint32_t k = 1; k < 3; k += 1) {
+        if (centroidMax[k] - centroidMin[k] > centroidMax[axis] - centroidMin[axis]) {
+            axis = k;
+        }
+    }
+
+    float extent = centroidMax[axis] - centroidMin[axis];
+
+    if (count <= SCENE_LEAF_SIZE) {
+        for (uint32_t i = first; i < first + count; i += 1) {
+            scene->leaves[i] = index;
+        }
+
+        node->skip = index + 1;
+        return;
+    }
+
+    uint32_t leftCount = count / 2;
+
+    // Binned surface area heuristic along the widest centroid axis
+    if (extent > 0.0f) {
+        uint32_t binCounts[SCENE_SAH_BINS] = {0};
+        float binMin[SCENE_SAH_BINS][3], binMax[SCENE_SAH_BINS][3];
+        float scale = SCENE_SAH_BINS / extent;
+
+        for (uint32_t b = 0; b < SCENE_SAH_BINS; b += 1) {
+            scene_aabb_empty(binMin[b], binMax[b]);
+        }
+
+        for (uint32_t i = first; i < first + count; i += 1) {
+            const SceneAabb *bounds = &scene->bounds[scene->objects[i]];
+            uint32_t bin = (uint32_t) ((scene_centroid(bounds, axis) - centroidMin[axis]) * scale);
+            bin = bin >= SCENE_SAH_BINS ? SCENE_SAH_BINS - 1 : bin;
+
+            binCounts[bin] += 1;
+            scene_aabb_grow(binMin[bin], binMax[bin], bounds->min, bounds->max);
+        }
+
+        float rightArea[SCENE_SAH_BINS];
+        uint32_t rightCount[SCENE_SAH_BINS];
+        float sweepMin[3], sweepMax[3];
+        uint32_t sweepCount = 0;
+
+        scene_aabb_empty(sweepMin, sweepMax);
+        for (uint32_t b = SCENE_SAH_BINS - 1; b > 0; b -= 1) {
+            scene_aabb_grow(sweepMin, sweepMax, binMin[b], binMax[b]);
+            sweepCount += binCounts[b];
+            rightArea[b] = scene_aabb_area(sweepMin, sweepMax);
+            rightCount[b] = sweepCount;
+        }
+
+        float bestCost = INFINITY;
+        uint32_t bestSplit = 1;
+
+        scene_aabb_empty(sweepMin, sweepMax);
+        sweepCount = 0;
+        for (uint32_t b = 1; b < SCENE_SAH_BINS; b += 1) {
+            scene_aabb_grow(sweepMin, sweepMax, binMin[b - 1], binMax[b - 1]);
+            sweepCount += binCounts[b - 1];
+
+            float cost = sweepCount * scene_aabb_area(sweepMin, sweepMax) + rightCount[b] * rightArea[b];
+
+            if (sweepCount > 0 && rightCount[b] > 0 && cost < bestCost) {
+                bestCost = cost;
+                bestSplit = b;
+            }
+        }
+
+        // Partition in place, bins below the split go left
+        uint32_t left = first;
+        uint32_t right = first + count;
+
+        while (left < right) {
+            const SceneAabb *bounds = &scene->bounds[scene->objects[left]];
+            uint32_t bin = (uint32_t) ((scene_centroid(bounds, axis) - centroidMin[axis]) * scale);
+            bin = bin >= SCENE_SAH_BINS ? SCENE_SAH_BINS - 1 : bin;
+
+            if (bin < bestSplit) {
+                left += 1;
+            } else {
+                right -= 1;
+                uint32_t swap = scene->objects[left];
+                scene->objects[left] = scene->objects[right];
+                scene->objects[right] = swap;
+            }
+        }
+
+        if (left > first && left < first + count) {
+            leftCount = left - first;
+        }
+    }
+
+    scene_build_node(scene, first, leftCount);
+    scene_build_node(scene, first + leftCount, count - leftCount);
+
+    node->skip = scene->nodeCount;
+}
+
+void scene_rebuild(Scene *scene) {
+    scene_free_tree(scene);
+    scene->needsBuild = false;
+    scene->needsRefit = false;
+
+    uint32_t count = scene->objectCount;
+
+    if (count == 0) {
+        return;
+    }
+
+    // Leaves start anywhere, so the last one may read up to SCENE_LANES - 1 floats past the end
+    uint32_t padded = count + SCENE_LANES - 1;
+
+    scene->slots = malloc(sizeof(uint32_t) * count);
+    scene->objects = malloc(sizeof(uint32_t) * count);
+    scene->leaves = malloc(sizeof(uint32_t) * count);
+    scene->nodes = malloc(sizeof(SceneNode) * count * 2);
+    scene->dirtyNodes = calloc(count * 2, sizeof(uint8_t));
+
+    bool allocated = scene->slots && scene->objects && scene->leaves && scene->nodes && scene->dirtyNodes;
+
+    for (uint32_t k = 0; k < 3; k += 1) {
+        scene->centers[k] = calloc(padded, sizeof(float));
+        scene->extents[k] = calloc(padded, sizeof(float));
+        allocated = allocated && scene->centers[k] && scene->extents[k];
+    }
+
+    if (! allocated) {
+        fprintf(stderr, "[ERROR]: Failed to allocate scene bvh!");
+        exit(EXIT_FAILURE);
+    }
+
+    for (uint32_t i = 0; i < count; i += 1) {
+        scene->objects[i] = i;
+    }
+
+    scene_build_node(scene, 0, count);
+
+    for (uint32_t slot = 0; slot < count; slot += 1) {
+        uint32_t object = scene->objects[slot];
+        const SceneAabb *bounds = &scene->bounds[object];
+
+        scene->slots[object] = slot;
+
+        for (uint32_t k = 0; k < 3; k += 1) {
+            scene->centers[k][slot] = (bounds->max[k] + bounds->min[k]) * 0.5f;
+            scene->extents[k][slot] = (bounds->max[k] - bounds->min[k]) * 0.5f;
+        }
+    }
+}
+
+static void scene_refit(Scene *scene) {
+    scene->needsRefit = false;
+
+    // Children always come after their parent, so walking backwards visits them first
+    for (uint32_t i = scene->nodeCount; i > 0; i -= 1) {
+        uint32_t index = i - 1;
+        SceneNode *node = &scene->nodes[index];
+
+        if (node->skip == index + 1) {
+            if (! scene->dirtyNodes[index]) {
+                continue;
+            }
+
+            scene_aabb_empty(node->min, node->max);
+
+            for (uint32_t slot = node->first; slot < node->first + node->count; slot += 1) {
+                for (uint32_t k = 0; k < 3; k += 1) {
+                    float min = scene->centers[k][slot] - scene->extents[k][slot];
+                    float max = scene->centers[k][slot] + scene->extents[k][slot];
+
+                    node->min[k] = min < node->min[k] ? min : node->min[k];
+                    node->max[k] = max > node->max[k] ? max : node->max[k];
+                }
+            }
+
+            continue;
+        }
+
+        const SceneNode *left = &scene->nodes[index + 1];
+        const SceneNode *right = &scene->nodes[left->skip];
+
+        if (scene->dirtyNodes[index + 1] || scene->dirtyNodes[left->skip]) {
+            scene_aabb_empty(node->min, node->max);
+            scene_aabb_grow(node->min, node->max, left->min, left->max);
+            scene_aabb_grow(node->min, node->max, right->min, right->max);
+            scene->dirtyNodes[index] = 1;
+        }
+    }
+
+    memset(scene->dirtyNodes, 0, scene->nodeCount);
+}
+
+uint32_t scene_add_object(Scene *scene, SceneAabb bounds, SceneDraw draw) {
+    if (scene->objectCount == scene->objectCapacity) {
+        scene_grow(scene);
+    }
+
+    uint32_t object = scene->objectCount;
+    scene->bounds[object] = bounds;
+    scene->draws[object] = draw;
+    scene->objectCount += 1;
+    scene->needsBuild = true;
+
+    return object;
+}
+
+void scene_move_object(Scene *scene, uint32_t object, SceneAabb bounds) {
+    scene->bounds[object] = bounds;
+
+    if (scene->needsBuild) {
+        return;
+    }
+
+    uint32_t slot = scene->slots[object];
+
+    for (uint32_t k = 0; k < 3; k += 1) {
+        scene->centers[k][slot] = (bounds.max[k] + bounds.min[k]) * 0.5f;
+        scene->extents[k][slot] = (bounds.max[k] - bounds.min[k]) * 0.5f;
+    }
+
+    scene->dirtyNodes[scene->leaves[slot]] = 1;
+    scene->needsRefit = true;
+}
+
+// Culling
+
+static void scene_extract_planes(float planes[6][4], const float m[4][4]) {
+    // Gribb/Hartmann on a column major matrix, row r is (m[0][r], m[1][r], m[2][r], m[3][r])
+    for (uint32_t c = 0; c < 4; c += 1) {
+        planes[0][c] = m[c][3] + m[c][0];
+        planes[1][c] = m[c][3] - m[c][0];
+        planes[2][c] = m[c][3] + m[c][1];
+        planes[3][c] = m[c][3] - m[c][1];
+        planes[4][c] = m[c][2];
+        planes[5][c] = m[c][3] - m[c][2];
+    }
+}
+
+static SceneTest scene_test_node(const float planes[6][4], const SceneNode *node) {
+    SceneTest result = SCENE_INSIDE;
+
+    for (uint32_t p = 0; p < 6; p += 1) {
+        const float *plane = planes[p];
+        float distance = plane[3];
+        float radius = 0.0f;
+
+        for (uint32_t k = 0; k < 3; k += 1) {
+            float center = (node->min[k] + node->max[k]) * 0.5f;
+            float extent = (node->max[k] - node->min[k]) * 0.5f;
+
+            distance += plane[k] * center;
+            radius += fabsf(plane[k]) * extent;
+        }
+
+        if (distance + radius < 0.0f) {
+            return SCENE_OUTSIDE;
+        }
+
+        if (distance - radius < 0.0f) {
+            result = SCENE_INTERSECTS;
+        }
+    }
+
+    return result;
+}
+
+static void scene_write(Scene *scene, uint32_t index, uint32_t slot) {
+    uint32_t object = scene->objects[slot];
+    const SceneDraw *draw = &scene->draws[object];
+
+    scene->instances[index] = (SceneInstance) {
+        .object = object,
+    };
+
+    scene->commands[index] = (VkDrawIndexedIndirectCommand) {
+        .indexCount = draw->indexCount,
+        .instanceCount = 1,
+        .firstIndex = draw->firstIndex,
+        .vertexOffset = draw->vertexOffset,
+        .firstInstance = index,
+    };
+}
+
+// One atomic per batch of visible objects reserves their spot in the output buffers
+static void scene_emit(Scene *scene, const uint32_t *slots, uint32_t count) {
+    uint32_t base = atomic_fetch_add_explicit(&scene->visibleCount, count, memory_order_relaxed);
+
+    for (uint32_t i = 0; i < count; i += 1) {
+        scene_write(scene, base + i, slots[i]);
+    }
+}
+
+static void scene_emit_range(Scene *scene, uint32_t first, uint32_t count) {
+    uint32_t base = atomic_fetch_add_explicit(&scene->visibleCount, count, memory_order_relaxed);
+
+    for (uint32_t i = 0; i < count; i += 1) {
+        scene_write(scene, base + i, first + i);
+    }
+}
+
+// Tests every object of a leaf against the frustum, SCENE_LANES boxes at a time
+static void scene_cull_leaf(Scene *scene, const SceneNode *node) {
+    uint32_t visible[SCENE_LEAF_SIZE + SCENE_LANES];
+    uint32_t visibleCount = 0;
+
+#if defined(__SSE2__)
+    __m128 planes[6][4];
+    for (uint32_t p = 0; p < 6; p += 1) {
+        for (uint32_t c = 0; c < 4; c += 1) {
+            planes[p][c] = _mm_set1_ps(scene->planes[p][c]);
+        }
+    }
+
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+#endif
+
+    for (uint32_t i = 0; i < node->count; i += SCENE_LANES) {
+        uint32_t slot = node->first + i;
+        uint32_t lanes = node->count - i < SCENE_LANES ? node->count - i : SCENE_LANES;
+        uint32_t mask = 0;
+
+#if defined(__SSE2__)
+        // The arrays are padded so reading past the last object is fine, extra lanes get masked off
+        __m128 centerX = _mm_loadu_ps(&scene->centers[0][slot]);
+        __m128 centerY = _mm_loadu_ps(&scene->centers[1][slot]);
+        __m128 centerZ = _mm_loadu_ps(&scene->centers[2][slot]);
+        __m128 extentX = _mm_loadu_ps(&scene->extents[0][slot]);
+        __m128 extentY = _mm_loadu_ps(&scene->extents[1][slot]);
+        __m128 extentZ = _mm_loadu_ps(&scene->extents[2][slot]);
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+        for (uint32_t p = 0; p < 6; p += 1) {
+            __m128 distance = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(planes[p][0], centerX), _mm_mul_ps(planes[p][1], centerY)),
+                _mm_add_ps(_mm_mul_ps(planes[p][2], centerZ), planes[p][3])
+            );
+
+            __m128 radius = _mm_add_ps(
+                _mm_add_ps(
+                    _mm_mul_ps(_mm_and_ps(planes[p][0], absMask), extentX),
+                    _mm_mul_ps(_mm_and_ps(planes[p][1], absMask), extentY)
+                ),
+                _mm_mul_ps(_mm_and_ps(planes[p][2], absMask), extentZ)
+            );
+
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+        }
+
+        mask = (uint32_t) _mm_movemask_ps(inside);
+#else
+        for (uint32_t lane = 0; lane < lanes; lane += 1) {
+            bool inside = true;
+
+            for (uint32_t p = 0; p < 6 && inside; p += 1) {
+                const float *plane = scene->planes[p];
+                float distance = plane[3];
+                float radius = 0.0f;
+
+                for (uint32_t k = 0; k < 3; k += 1) {
+                    distance += plane[k] * scene->centers[k][slot + lane];
+                    radius += fabsf(plane[k]) * scene->extents[k][slot + lane];
+                }
+
+                inside = distance + radius >= 0.0f;
+            }
+
+            mask |= (uint32_t) inside << lane;
+        }
+#endif
+
+        mask &= (1u << lanes) - 1;
+
+        for (uint32_t lane = 0; lane < lanes; lane += 1) {
+            if (mask & (1u << lane)) {
+                visible[visibleCount] = slot + lane;
+                visibleCount += 1;
+            }
+        }
+    }
+
+    if (visibleCount > 0) {
+        scene_emit(scene, visible, visibleCount);
+    }
+}
+
+// Stackless walk over a subtree thanks to the skip indices
+static void scene_cull_subtree(Scene *scene, uint32_t root) {
+    uint32_t end = scene->nodes[root].skip;
+    uint32_t index = root;
+
+    while (index < end) {
+        const SceneNode *node = &scene->nodes[index];
+        SceneTest test = scene_test_node(scene->planes, node);
+
+        if (test == SCENE_OUTSIDE) {
+            index = node->skip;
+        } else if (test == SCENE_INSIDE) {
+            scene_emit_range(scene, node->first, node->count);
+            index = node->skip;
+        } else if (node->skip == index + 1) {
+            scene_cull_leaf(scene, node);
+            index = node->skip;
+        } else {
+            index += 1;
+        }
+    }
+}
+
+static void scene_cull_tasks(Scene *scene) {
+    while (true) {
+        uint32_t task = atomic_fetch_add_explicit(&scene->nextTask, 1, memory_order_relaxed);
+
+        if (task >= scene->taskCount) {
+            return;
+        }
+
+        scene_cull_subtree(scene, scene->tasks[task]);
+    }
+}
+
+// Splits the top of the tree into enough subtrees to keep every thread busy
+static void scene_split_tasks(Scene *scene) {
+    uint32_t target = scene->threadCount * 8;
+    target = target > SCENE_MAX_TASKS / 2 ? SCENE_MAX_TASKS / 2 : target;
+
+    scene->tasks[0] = 0;
+    scene->taskCount = 1;
+
+    while (scene->taskCount < target) {
+        // Expand the biggest interior subtree
+        uint32_t biggest = SCENE_MAX_TASKS;
+
+        for (uint32_t t = 0; t < scene->taskCount; t += 1) {
+            const SceneNode *node = &scene->nodes[scene->tasks[t]];
+
+            if (node->skip != scene->tasks[t] + 1 &&
+                (biggest == SCENE_MAX_TASKS || node->count > scene->nodes[scene->tasks[biggest]].count)) {
+                biggest = t;
+            }
+        }
+
+        if (biggest == SCENE_MAX_TASKS) {
+            break;
+        }
+
+        uint32_t index = scene->tasks[biggest];
+        scene->tasks[biggest] = index + 1;
+        scene->tasks[scene->taskCount] = scene->nodes[index + 1].skip;
+        scene->taskCount += 1;
+    }
+}
+
+static void *scene_worker(void *argument) {
+    Scene *scene = argument;
+    uint64_t generation = 0;
+
+    pthread_mutex_lock(&scene->mutex);
+
+    while (true) {
+        while (! scene->quit && scene->generation == generation) {
+            pthread_cond_wait(&scene->start, &scene->mutex);
+        }
+
+        if (scene->quit) {
+            break;
+        }
+
+        generation = scene->generation;
+        pthread_mutex_unlock(&scene->mutex);
+
+        scene_cull_tasks(scene);
+
+        pthread_mutex_lock(&scene->mutex);
+        scene->busyThreads -= 1;
+
+        if (scene->busyThreads == 0) {
+            pthread_cond_signal(&scene->done);
+        }
+    }
+
+    pthread_mutex_unlock(&scene->mutex);
+
+    return NULL;
+}
+
+uint32_t scene_cull(
+    Scene *scene,
+    const float viewProjection[4][4],
+    SceneInstance *instances,
+    VkDrawIndexedIndirectCommand *commands
+) {
+    if (scene->needsBuild) {
+        scene_rebuild(scene);
+    } else if (scene->needsRefit) {
+        scene_refit(scene);
+    }
+
+    if (scene->nodeCount == 0) {
+        return 0;
+    }
+
+    scene_extract_planes(scene->planes, viewProjection);
+    scene_split_tasks(scene);
+
+    scene->instances = instances;
+    scene->commands = commands;
+    atomic_store(&scene->nextTask, 0);
+    atomic_store(&scene->visibleCount, 0);
+
+    // The calling thread works too, the rest are woken up for this generation
+    pthread_mutex_lock(&scene->mutex);
+    scene->busyThreads = scene->threadCount - 1;
+    scene->generation += 1;
+    pthread_cond_broadcast(&scene->start);
+    pthread_mutex_unlock(&scene->mutex);
+
+    scene_cull_tasks(scene);
+
+    pthread_mutex_lock(&scene->mutex);
+    while (scene->busyThreads > 0) {
+        pthread_cond_wait(&scene->done, &scene->mutex);
+    }
+    pthread_mutex_unlock(&scene->mutex);
+
+    return atomic_load(&scene->visibleCount);
+}
+
+Scene *scene_create(uint32_t threadCount) {
+    Scene *scene = calloc(1, sizeof(Scene));
+
+    if (scene == NULL) {
+        fprintf(stderr, "[ERROR]: Failed to allocate scene!");
+        exit(EXIT_FAILURE);
+    }
+
+    if (threadCount == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threadCount = online > 0 ? (uint32_t) online : 1;
+    }
+
+    scene->threadCount = threadCount > SCENE_MAX_THREADS ? SCENE_MAX_THREADS : threadCount;
+    atomic_init(&scene->nextTask, 0);
+    atomic_init(&scene->visibleCount, 0);
+
+    pthread_mutex_init(&scene->mutex, NULL);
+    pthread_cond_init(&scene->start, NULL);
+    pthread_cond_init(&scene->done, NULL);
+
+    for (uint32_t i = 1; i < scene->threadCount; i += 1) {
+        if (pthread_create(&scene->threads[i], NULL, scene_worker, scene) != 0) {
+            fprintf(stderr, "[ERROR]: Failed to spawn culling thread!");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    return scene;
+}
+
+void scene_destroy(Scene *scene) {
+    pthread_mutex_lock(&scene->mutex);
+    scene->quit = true;
+    pthread_cond_broadcast(&scene->start);
+    pthread_mutex_unlock(&scene->mutex);
+
+    for (uint32_t i = 1; i < scene->threadCount; i += 1) {
+        pthread_join(scene->threads[i], NULL);
+    }
+
+    pthread_mutex_destroy(&scene->mutex);
+    pthread_cond_destroy(&scene->start);
+    pthread_cond_destroy(&scene->done);
+
+    scene_free_tree(scene);
+    free(scene->bounds);
+    free(scene->draws);
+    free(scene);
+}
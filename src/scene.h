@@ -0,0 +1,100 @@
+#ifndef SCENE
+#define SCENE
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <vulkan/vulkan_core.h>
+
+#define SCENE_LEAF_SIZE 8
+#define SCENE_MAX_THREADS 64
+#define SCENE_MAX_TASKS 512
+
+typedef struct SceneAabb {
+    float min[3];
+    float max[3];
+} SceneAabb;
+
+// Where the object's mesh lives in the shared vertex and index buffers
+typedef struct SceneDraw {
+    uint32_t indexCount;
+    uint32_t firstIndex;
+    int32_t vertexOffset;
+} SceneDraw;
+
+// Written per visible object, the matching indirect command uses its index as firstInstance
+typedef struct SceneInstance {
+    uint32_t object;
+} SceneInstance;
+
+// Nodes are stored in depth first order: the left child directly follows its parent and
+// skip points past the whole subtree, which is also where the right child starts.
+typedef struct SceneNode {
+    float min[3];
+    uint32_t first;
+    float max[3];
+    uint32_t count;
+    uint32_t skip;
+} SceneNode;
+
+typedef struct Scene {
+    uint32_t objectCount;
+    uint32_t objectCapacity;
+
+    // Indexed by object id
+    SceneAabb *bounds;
+    SceneDraw *draws;
+    uint32_t *slots;
+
+    // Indexed by bvh order, centers and half extents are padded for the simd kernel's unaligned loads
+    uint32_t *objects;
+    uint32_t *leaves;
+    float *centers[3];
+    float *extents[3];
+
+    SceneNode *nodes;
+    uint8_t *dirtyNodes;
+    uint32_t nodeCount;
+    bool needsBuild;
+    bool needsRefit;
+
+    // Culling job, shared with the workers
+    float planes[6][4];
+    uint32_t tasks[SCENE_MAX_TASKS];
+    uint32_t taskCount;
+    atomic_uint nextTask;
+    atomic_uint visibleCount;
+    SceneInstance *instances;
+    VkDrawIndexedIndirectCommand *commands;
+
+    pthread_t threads[SCENE_MAX_THREADS];
+    uint32_t threadCount;
+    pthread_mutex_t mutex;
+    pthread_cond_t start;
+    pthread_cond_t done;
+    uint64_t generation;
+    uint32_t busyThreads;
+    bool quit;
+} Scene;
+
+// threadCount includes the calling thread, 0 picks the number of online cpus
+Scene *scene_create(uint32_t threadCount);
+
+uint32_t scene_add_object(Scene *scene, SceneAabb bounds, SceneDraw draw);
+
+// Only refits the bvh nodes above the object, call scene_rebuild once the tree has degraded too much
+void scene_move_object(Scene *scene, uint32_t object, SceneAabb bounds);
+void scene_rebuild(Scene *scene);
+
+// viewProjection is a column major (cglm) matrix with a [0, 1] depth range. Both outputs need room for
+// every object; the visible ones are written in no particular order and their count is returned,
+// ready to be used as the draw count of vkCmdDrawIndexedIndirect.
+uint32_t scene_cull(
+    Scene *scene,
+    const float viewProjection[4][4],
+    SceneInstance *instances,
+    VkDrawIndexedIndirectCommand *commands
+);
+
+void scene_destroy(Scene *scene);
+#endif
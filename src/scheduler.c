@@ -0,0 +1,282 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "scheduler.h"
+
+Scheduler scheduler_create(VkDevice device) {
+    Scheduler scheduler;
+    memset(&scheduler, 0, sizeof(scheduler));
+    scheduler.device = device;
+
+    return scheduler;
+}
+
+uint32_t scheduler_add_queue(Scheduler *scheduler, VkQueue queue) {
+    for (uint32_t i = 0; i < scheduler->queueCount; i += 1) {
+        if (scheduler->queues[i].queue == queue) {
+            return i;
+        }
+    }
+
+    if (scheduler->queueCount == SCHEDULER_MAX_QUEUES) {
+        fprintf(stderr, "[ERROR]: Too many scheduler queues!");
+        exit(EXIT_FAILURE);
+    }
+
+    VkSemaphoreTypeCreateInfo timelineCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+        .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+        .initialValue = 0,
+    };
+
+    VkSemaphoreCreateInfo semaphoreCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = &timelineCreateInfo,
+    };
+
+    uint32_t index = scheduler->queueCount;
+    SchedulerQueue *schedulerQueue = &scheduler->queues[index];
+
+    if (vkCreateSemaphore(scheduler->device, &semaphoreCreateInfo, NULL, &schedulerQueue->timeline) != VK_SUCCESS) {
+        fprintf(stderr, "[ERROR]: Failed to create timeline semaphore!");
+        exit(EXIT_FAILURE);
+    }
+
+    schedulerQueue->queue = queue;
+    schedulerQueue->pendingValue = 1;
+    schedulerQueue->submittedValue = 0;
+    scheduler->queueCount += 1;
+
+    return index;
+}
+
+static bool scheduler_has_pending(const SchedulerQueue *queue) {
+    const SchedulerBatch *batch = &queue->batch;
+
+    return batch->commandBufferCount > 0 || batch->waitCount > 0 || batch->signalCount > 0;
+}
+
+static void scheduler_submit(Scheduler *scheduler, uint32_t index) {
+    SchedulerQueue *queue = &scheduler->queues[index];
+    SchedulerBatch *batch = &queue->batch;
+
+    // Every batch advances the queue's timeline, after all of its commands
+    batch->signals[batch->signalCount] = (VkSemaphoreSubmitInfo) {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+        .semaphore = queue->timeline,
+        .value = queue->pendingValue,
+        .stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+    };
+
+    VkSubmitInfo2 submitInfo = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+        .waitSemaphoreInfoCount = batch->waitCount,
+        .pWaitSemaphoreInfos = batch->waits,
+        .commandBufferInfoCount = batch->commandBufferCount,
+        .pCommandBufferInfos = batch->commandBuffers,
+        .signalSemaphoreInfoCount = batch->signalCount + 1,
+        .pSignalSemaphoreInfos = batch->signals,
+    };
+
+    if (vkQueueSubmit2(queue->queue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+        fprintf(stderr, "[ERROR]: Failed to submit to queue!");
+        exit(EXIT_FAILURE);
+    }
+
+    queue->submittedValue = queue->pendingValue;
+    queue->pendingValue += 1;
+
+    batch->commandBufferCount = 0;
+    batch->waitCount = 0;
+    batch->signalCount = 0;
+}
+
+SchedulerPoint scheduler_enqueue(Scheduler *scheduler, uint32_t queue, VkCommandBuffer commandBuffer) {
+    SchedulerQueue *schedulerQueue = &scheduler->queues[queue];
+    SchedulerBatch *batch = &schedulerQueue->batch;
+
+    if (batch->commandBufferCount == SCHEDULER_MAX_COMMAND_BUFFERS) {
+        scheduler_submit(scheduler, queue);
+    }
+
+    batch->commandBuffers[batch->commandBufferCount] = (VkCommandBufferSubmitInfo) {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+        .commandBuffer = commandBuffer,
+        .deviceMask = 0,
+    };
+    batch->commandBufferCount += 1;
+
+    return (SchedulerPoint) {
+        .queue = queue,
+        .value = schedulerQueue->pendingValue,
+    };
+}
+
+static void scheduler_add_wait(Scheduler *scheduler, uint32_t queue, VkSemaphore semaphore, uint64_t value, uint32_t sourceQueue, VkPipelineStageFlags2 stageMask) {
+    SchedulerBatch *batch = &scheduler->queues[queue].batch;
+
+    // Timeline values only move forward so waiting on the larger one covers both
+    if (sourceQueue != SCHEDULER_NO_QUEUE) {
+        for (uint32_t i = 0; i < batch->waitCount; i += 1) {
+            if (batch->waits[i].semaphore == semaphore) {
+                batch->waits[i].value = value > batch->waits[i].value ? value : batch->waits[i].value;
+                batch->waits[i].stageMask |= stageMask;
+                return;
+            }
+        }
+    }
+
+    // The commands already in the batch didn't need this wait, so they can go out without it
+    if (batch->waitCount == SCHEDULER_MAX_WAITS) {
+        scheduler_submit(scheduler, queue);
+    }
+
+    batch->waits[batch->waitCount] = (VkSemaphoreSubmitInfo) {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+        .semaphore = semaphore,
+        .value = value,
+        .stageMask = stageMask,
+    };
+    batch->waitQueues[batch->waitCount] = sourceQueue;
+    batch->waitCount += 1;
+}
+
+void scheduler_wait_point(Scheduler *scheduler, uint32_t queue, SchedulerPoint point, VkPipelineStageFlags2 stageMask) {
+    const SchedulerQueue *source = &scheduler->queues[point.queue];
+
+    // Ordering inside the pending batch is up to the command buffers' own barriers
+    if (point.queue == queue && point.value >= source->pendingValue) {
+        return;
+    }
+
+    scheduler_add_wait(scheduler, queue, source->timeline, point.value, point.queue, stageMask);
+}
+
+void scheduler_wait_semaphore(Scheduler *scheduler, uint32_t queue, VkSemaphore semaphore, VkPipelineStageFlags2 stageMask) {
+    scheduler_add_wait(scheduler, queue, semaphore, 0, SCHEDULER_NO_QUEUE, stageMask);
+}
+
+void scheduler_signal_semaphore(Scheduler *scheduler, uint32_t queue, VkSemaphore semaphore, VkPipelineStageFlags2 stageMask) {
+    SchedulerBatch *batch = &scheduler->queues[queue].batch;
+
+    // Signals cover everything earlier in submission order, so an early submit is harmless
+    if (batch->signalCount == SCHEDULER_MAX_SIGNALS) {
+        scheduler_submit(scheduler, queue);
+    }
+
+    batch->signals[batch->signalCount] = (VkSemaphoreSubmitInfo) {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+        .semaphore = semaphore,
+        .value = 0,
+        .stageMask = stageMask,
+    };
+    batch->signalCount += 1;
+}
+
+static bool scheduler_is_ready(const Scheduler *scheduler, const SchedulerQueue *queue) {
+    const SchedulerBatch *batch = &queue->batch;
+
+    for (uint32_t i = 0; i < batch->waitCount; i += 1) {
+        uint32_t source = batch->waitQueues[i];
+
+        if (source != SCHEDULER_NO_QUEUE && scheduler->queues[source].submittedValue < batch->waits[i].value) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void scheduler_flush(Scheduler *scheduler) {
+    // Submit producers before their consumers. Timelines do allow waiting before the
+    // signal is submitted, so anything left over (a cycle) still goes out in order.
+    bool submitted = true;
+
+    while (submitted) {
+        submitted = false;
+
+        for (uint32_t i = 0; i < scheduler->queueCount; i += 1) {
+            SchedulerQueue *queue = &scheduler->queues[i];
+
+            if (scheduler_has_pending(queue) && scheduler_is_ready(scheduler, queue)) {
+                scheduler_submit(scheduler, i);
+                submitted = true;
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < scheduler->queueCount; i += 1) {
+        if (scheduler_has_pending(&scheduler->queues[i])) {
+            scheduler_submit(scheduler, i);
+        }
+    }
+}
+
+bool scheduler_is_complete(const Scheduler *scheduler, SchedulerPoint point) {
+    uint64_t value = 0;
+
+    if (vkGetSemaphoreCounterValue(scheduler->device, scheduler->queues[point.queue].timeline, &value) != VK_SUCCESS) {
+        fprintf(stderr, "[ERROR]: Failed to read timeline semaphore!");
+        exit(EXIT_FAILURE);
+    }
+
+    return value >= point.value;
+}
+
+bool scheduler_wait(Scheduler *scheduler, SchedulerPoint point, uint64_t timeout) {
+    const SchedulerQueue *queue = &scheduler->queues[point.queue];
+
+    if (point.value > queue->submittedValue) {
+        scheduler_flush(scheduler);
+    }
+
+    VkSemaphoreWaitInfo waitInfo = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+        .semaphoreCount = 1,
+        .pSemaphores = &queue->timeline,
+        .pValues = &point.value,
+    };
+
+    VkResult result = vkWaitSemaphores(scheduler->device, &waitInfo, timeout);
+
+    if (result == VK_TIMEOUT) {
+        return false;
+    }
+
+    if (result != VK_SUCCESS) {
+        fprintf(stderr, "[ERROR]: Failed to wait for timeline semaphore!");
+        exit(EXIT_FAILURE);
+    }
+
+    return true;
+}
+
+void scheduler_wait_idle(Scheduler *scheduler) {
+    scheduler_flush(scheduler);
+
+    VkSemaphore semaphores[SCHEDULER_MAX_QUEUES];
+    uint64_t values[SCHEDULER_MAX_QUEUES];
+
+    for (uint32_t i = 0; i < scheduler->queueCount; i += 1) {
+        semaphores[i] = scheduler->queues[i].timeline;
+        values[i] = scheduler->queues[i].submittedValue;
+    }
+
+    VkSemaphoreWaitInfo waitInfo = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+        .semaphoreCount = scheduler->queueCount,
+        .pSemaphores = semaphores,
+        .pValues = values,
+    };
+
+    if (scheduler->queueCount > 0 && vkWaitSemaphores(scheduler->device, &waitInfo, UINT64_MAX) != VK_SUCCESS) {
+        fprintf(stderr, "[ERROR]: Failed to wait for timeline semaphores!");
+        exit(EXIT_FAILURE);
+    }
+}
+
+void scheduler_destroy(Scheduler scheduler) {
+    for (uint32_t i = 0; i < scheduler.queueCount; i += 1) {
+        vkDestroySemaphore(scheduler.device, scheduler.queues[i].timeline, NULL);
+    }
+}
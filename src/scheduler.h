@@ -0,0 +1,74 @@
+#ifndef SCHEDULER
+#define SCHEDULER
+#include <stdbool.h>
+#include <stdint.h>
+#include <vulkan/vulkan_core.h>
+
+#define SCHEDULER_MAX_QUEUES 4
+#define SCHEDULER_MAX_COMMAND_BUFFERS 32
+#define SCHEDULER_MAX_WAITS 8
+#define SCHEDULER_MAX_SIGNALS 4
+#define SCHEDULER_NO_QUEUE UINT32_MAX
+
+// A value on one queue's timeline, reached once everything enqueued before it has executed
+typedef struct SchedulerPoint {
+    uint32_t queue;
+    uint64_t value;
+} SchedulerPoint;
+
+// Work recorded for a queue since its last submit, flushed as a single VkSubmitInfo2
+typedef struct SchedulerBatch {
+    VkCommandBufferSubmitInfo commandBuffers[SCHEDULER_MAX_COMMAND_BUFFERS];
+    VkSemaphoreSubmitInfo waits[SCHEDULER_MAX_WAITS];
+    // Queue owning each timeline wait, SCHEDULER_NO_QUEUE for binary semaphores
+    uint32_t waitQueues[SCHEDULER_MAX_WAITS];
+    VkSemaphoreSubmitInfo signals[SCHEDULER_MAX_SIGNALS + 1];
+    uint32_t commandBufferCount;
+    uint32_t waitCount;
+    uint32_t signalCount;
+} SchedulerBatch;
+
+typedef struct SchedulerQueue {
+    VkQueue queue;
+    VkSemaphore timeline;
+    // Value the pending batch will signal
+    uint64_t pendingValue;
+    // Last value handed to vkQueueSubmit2
+    uint64_t submittedValue;
+    SchedulerBatch batch;
+} SchedulerQueue;
+
+typedef struct Scheduler {
+    VkDevice device;
+    SchedulerQueue queues[SCHEDULER_MAX_QUEUES];
+    uint32_t queueCount;
+} Scheduler;
+
+// Needs the timelineSemaphore (1.2) and synchronization2 (1.3) device features
+Scheduler scheduler_create(VkDevice device);
+
+// Registering the same VkQueue twice returns the same index, so a shared graphics/present queue has one timeline
+uint32_t scheduler_add_queue(Scheduler *scheduler, VkQueue queue);
+
+// Appends to the queue's pending batch, the returned point is reached once the batch executes
+SchedulerPoint scheduler_enqueue(Scheduler *scheduler, uint32_t queue, VkCommandBuffer commandBuffer);
+
+// Makes the queue's pending batch wait for another point, waits on the same timeline are merged
+void scheduler_wait_point(Scheduler *scheduler, uint32_t queue, SchedulerPoint point, VkPipelineStageFlags2 stageMask);
+
+// Binary semaphores, for swapchain acquire and present which can't use timelines
+void scheduler_wait_semaphore(Scheduler *scheduler, uint32_t queue, VkSemaphore semaphore, VkPipelineStageFlags2 stageMask);
+void scheduler_signal_semaphore(Scheduler *scheduler, uint32_t queue, VkSemaphore semaphore, VkPipelineStageFlags2 stageMask);
+
+// Submits every pending batch, one vkQueueSubmit2 per queue that has work
+void scheduler_flush(Scheduler *scheduler);
+
+bool scheduler_is_complete(const Scheduler *scheduler, SchedulerPoint point);
+
+// Blocks the cpu until the point is reached, flushing first if it's still pending. Returns false on timeout.
+bool scheduler_wait(Scheduler *scheduler, SchedulerPoint point, uint64_t timeout);
+void scheduler_wait_idle(Scheduler *scheduler);
+
+// The queues must be idle, see scheduler_wait_idle
+void scheduler_destroy(Scheduler scheduler);
+#endif